@@ -0,0 +1,131 @@
+#ifndef LC_ADMISSION_CONTROLLER_H
+#define LC_ADMISSION_CONTROLLER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+struct AdmissionOptions {
+    std::chrono::nanoseconds target_latency = std::chrono::milliseconds(5);
+    std::size_t              initial_limit  = 256;
+    std::size_t              min_limit      = 1;
+    std::size_t              max_limit      = 65536;
+    double                   backoff        = 0.9;  // multiplicative decrease
+};
+
+// Adaptive cap on tasks in flight (queued plus running), adjusted by AIMD
+// on queueing latency. Every completed task reports how long it waited in
+// the queue; once per window of `limit()` samples the limit shrinks by
+// `backoff` if any sample exceeded the target and grows by one otherwise.
+// Growth only happens in windows where the limit turned a submission away,
+// so a lightly loaded pool does not drift up to `max_limit`.
+//
+// Admission is a single CAS; the only other shared writes are one
+// fetch_sub and one fetch_add per completed task.
+class AdmissionController {
+public:
+
+    explicit AdmissionController(const AdmissionOptions &options = {}) :
+        target_ns_(options.target_latency.count()),
+        min_limit_(options.min_limit),
+        max_limit_(options.max_limit),
+        backoff_(options.backoff) {
+        if (options.min_limit == 0 || options.min_limit > options.max_limit ||
+            options.initial_limit < options.min_limit ||
+            options.initial_limit > options.max_limit) {
+            throw std::invalid_argument(
+                "Admission limits must satisfy 0 < min <= initial <= max.");
+        }
+        if (!(options.backoff > 0.0 && options.backoff < 1.0)) {
+            throw std::invalid_argument("Backoff must be in (0, 1).");
+        }
+        limit_.store(options.initial_limit, std::memory_order_relaxed);
+        inflight_.store(0, std::memory_order_relaxed);
+        samples_.store(0, std::memory_order_relaxed);
+        congested_.store(false, std::memory_order_relaxed);
+        limited_.store(false, std::memory_order_relaxed);
+    }
+
+    AdmissionController(const AdmissionController &)            = delete;
+    AdmissionController &operator=(const AdmissionController &) = delete;
+
+    // Take an in-flight slot; false means the caller should shed the task.
+    [[nodiscard]] bool try_acquire() {
+        size_t inflight = inflight_.load(std::memory_order_relaxed);
+        do {
+            if (inflight >= limit_.load(std::memory_order_relaxed)) {
+                if (!limited_.load(std::memory_order_relaxed)) {
+                    limited_.store(true, std::memory_order_relaxed);
+                }
+                return false;
+            }
+        } while (!inflight_.compare_exchange_weak(inflight,
+                                                  inflight + 1,
+                                                  std::memory_order_relaxed));
+        return true;
+    }
+
+    // Take a slot regardless of the limit, for work that cannot be refused.
+    void acquire() {
+        inflight_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Give back a slot whose task ran after waiting `queueing_latency`.
+    void release(std::chrono::nanoseconds queueing_latency) {
+        inflight_.fetch_sub(1, std::memory_order_relaxed);
+        if (queueing_latency.count() > target_ns_) {
+            congested_.store(true, std::memory_order_relaxed);
+        }
+        size_t limit = limit_.load(std::memory_order_relaxed);
+        if (samples_.fetch_add(1, std::memory_order_relaxed) + 1 < limit) {
+            return;
+        }
+        // Exactly one thread observes the full window and closes it.
+        if (samples_.exchange(0, std::memory_order_relaxed) < limit) {
+            return;
+        }
+        bool limited = limited_.exchange(false, std::memory_order_relaxed);
+        if (congested_.exchange(false, std::memory_order_relaxed)) {
+            size_t lowered = static_cast<size_t>(limit * backoff_);
+            limit_.store(std::max(min_limit_, std::min(lowered, limit - 1)),
+                         std::memory_order_relaxed);
+        } else if (limited && limit < max_limit_) {
+            limit_.store(limit + 1, std::memory_order_relaxed);
+        }
+    }
+
+    // Give back a slot whose task never ran, e.g. because the queue was full.
+    void abandon() {
+        inflight_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    size_t limit() const {
+        return limit_.load(std::memory_order_relaxed);
+    }
+
+    size_t inflight() const {
+        return inflight_.load(std::memory_order_relaxed);
+    }
+
+private:
+    const int64_t                   target_ns_;
+    const std::size_t               min_limit_;
+    const std::size_t               max_limit_;
+    const double                    backoff_;
+    alignas(64) std::atomic<size_t> inflight_;
+    std::atomic<size_t>             limit_;
+    alignas(64) std::atomic<size_t> samples_;
+    std::atomic<bool>               congested_;
+    std::atomic<bool>               limited_;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_ADMISSION_CONTROLLER_H
@@ -0,0 +1,227 @@
+#ifndef LC_BLOCKING_MPMC_QUEUE_H
+#define LC_BLOCKING_MPMC_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "lc_config.h"
+#include "lc_futex.h"
+#include "lc_mpmc_queue.h"
+
+LC_NAMESPACE_BEGIN
+
+// MPMCQueue with blocking and timed push/pop. A thread that finds the queue
+// full (or empty) spins briefly, then parks on a futex. Each side keeps an
+// event counter to park on and a count of parked threads, so the opposite
+// side only makes a wake-up call when somebody is actually parked; the
+// uncontended path adds one fence and one load to the raw queue operation
+// (the fence is what keeps a wake-up from being lost).
+//
+// close() wakes everyone: pushes fail from then on, pops drain what is left
+// and then fail. Items pushed concurrently with close() may stay queued.
+template <typename Tp_>
+class BlockingMPMCQueue {
+    using Clock     = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    static constexpr int kSpinCount = 128;
+
+public:
+
+    explicit BlockingMPMCQueue(std::size_t queue_size) : queue_(queue_size) {
+        not_empty_.store(0, std::memory_order_relaxed);
+        not_full_.store(0, std::memory_order_relaxed);
+        consumers_waiting_.store(0, std::memory_order_relaxed);
+        producers_waiting_.store(0, std::memory_order_relaxed);
+        closed_.store(false, std::memory_order_relaxed);
+    }
+
+    BlockingMPMCQueue(const BlockingMPMCQueue &)            = delete;
+    BlockingMPMCQueue &operator=(const BlockingMPMCQueue &) = delete;
+
+    // Blocks while the queue is full. Returns false if it was closed.
+    bool push(Tp_ &&value) {
+        return push_until(std::move(value), nullptr);
+    }
+
+    bool push(const Tp_ &value) {
+        return push_until(value, nullptr);
+    }
+
+    // Returns false on timeout or close, leaving `value` untouched.
+    template <typename Rep, typename Period>
+    bool push_for(Tp_ &&value, std::chrono::duration<Rep, Period> timeout) {
+        TimePoint deadline = Clock::now() + timeout;
+        return push_until(std::move(value), &deadline);
+    }
+
+    template <typename Rep, typename Period>
+    bool push_for(const Tp_                         &value,
+                  std::chrono::duration<Rep, Period> timeout) {
+        TimePoint deadline = Clock::now() + timeout;
+        return push_until(value, &deadline);
+    }
+
+    [[nodiscard]] bool try_push(Tp_ &&value) {
+        return try_push_impl(std::move(value));
+    }
+
+    [[nodiscard]] bool try_push(const Tp_ &value) {
+        return try_push_impl(value);
+    }
+
+    // Blocks while the queue is empty. Returns false once it is closed and
+    // drained.
+    bool pop(Tp_ &value) {
+        return pop_until(value, nullptr);
+    }
+
+    // Returns false on timeout, or once the queue is closed and drained.
+    template <typename Rep, typename Period>
+    bool try_pop_for(Tp_ &value, std::chrono::duration<Rep, Period> timeout) {
+        TimePoint deadline = Clock::now() + timeout;
+        return pop_until(value, &deadline);
+    }
+
+    [[nodiscard]] bool try_pop(Tp_ &value) {
+        if (!queue_.dequeue(value)) {
+            return false;
+        }
+        wake_one(not_full_, producers_waiting_);
+        return true;
+    }
+
+    void close() {
+        closed_.store(true, std::memory_order_seq_cst);
+        not_empty_.fetch_add(1, std::memory_order_release);
+        not_full_.fetch_add(1, std::memory_order_release);
+        futex_wake(not_empty_, INT_MAX);
+        futex_wake(not_full_, INT_MAX);
+    }
+
+    bool closed() const {
+        return closed_.load(std::memory_order_acquire);
+    }
+
+    std::size_t size() const {
+        return queue_.size();
+    }
+
+    bool empty() const {
+        return queue_.empty();
+    }
+
+    std::size_t capacity() const {
+        return queue_.capacity();
+    }
+
+private:
+
+    template <typename Up_>
+    bool try_push_impl(Up_ &&value) {
+        if (closed_.load(std::memory_order_acquire) ||
+            !queue_.enqueue(std::forward<Up_>(value))) {
+            return false;
+        }
+        wake_one(not_empty_, consumers_waiting_);
+        return true;
+    }
+
+    template <typename Up_>
+    bool push_until(Up_ &&value, const TimePoint *deadline) {
+        for (int i = 0; i < kSpinCount; ++i) {
+            if (closed_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            if (queue_.enqueue(std::forward<Up_>(value))) {
+                wake_one(not_empty_, consumers_waiting_);
+                return true;
+            }
+            cpu_relax();
+        }
+        while (true) {
+            uint32_t seen = not_full_.load(std::memory_order_acquire);
+            producers_waiting_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool closed = closed_.load(std::memory_order_acquire);
+            if (!closed && queue_.enqueue(std::forward<Up_>(value))) {
+                producers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+                wake_one(not_empty_, consumers_waiting_);
+                return true;
+            }
+            bool woken = closed || park(not_full_, seen, deadline);
+            producers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+            if (closed || !woken) {
+                return false;
+            }
+        }
+    }
+
+    bool pop_until(Tp_ &value, const TimePoint *deadline) {
+        for (int i = 0; i < kSpinCount; ++i) {
+            if (try_pop(value)) {
+                return true;
+            }
+            if (closed_.load(std::memory_order_acquire)) {
+                return try_pop(value);
+            }
+            cpu_relax();
+        }
+        while (true) {
+            uint32_t seen = not_empty_.load(std::memory_order_acquire);
+            consumers_waiting_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // Read the flag first: closed and still empty means drained.
+            bool closed = closed_.load(std::memory_order_acquire);
+            if (queue_.dequeue(value)) {
+                consumers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+                wake_one(not_full_, producers_waiting_);
+                return true;
+            }
+            bool woken = closed || park(not_empty_, seen, deadline);
+            consumers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+            if (closed) {
+                return false;
+            }
+            if (!woken) {
+                return try_pop(value);  // One last look after the timeout
+            }
+        }
+    }
+
+    static bool park(std::atomic<uint32_t> &event,
+                     uint32_t               seen,
+                     const TimePoint       *deadline) {
+        if (deadline == nullptr) {
+            futex_wait(event, seen);
+            return true;
+        }
+        return futex_wait_until(event, seen, *deadline);
+    }
+
+    // Pairs with the fence a parking thread issues between registering as a
+    // waiter and re-checking the queue, so one of the two sees the other.
+    static void wake_one(std::atomic<uint32_t>       &event,
+                         const std::atomic<uint32_t> &waiting) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) != 0) {
+            event.fetch_add(1, std::memory_order_release);
+            futex_wake(event, 1);
+        }
+    }
+
+    MPMCQueue<Tp_>                     queue_;
+    alignas(64) std::atomic<uint32_t> not_empty_;
+    std::atomic<uint32_t>             consumers_waiting_;
+    alignas(64) std::atomic<uint32_t> not_full_;
+    std::atomic<uint32_t>             producers_waiting_;
+    alignas(64) std::atomic<bool>     closed_;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_BLOCKING_MPMC_QUEUE_H
@@ -0,0 +1,131 @@
+#ifndef LC_BUMP_ARENA_H
+#define LC_BUMP_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+// Single-threaded bump-pointer allocator for short-lived scratch memory.
+// Allocation moves a cursor; deallocation is a no-op and reset() frees
+// everything at once. When a block runs out the arena chains another, and
+// the next reset() merges the chain into one block of the combined size,
+// so a workload that repeats settles on a single block and stops calling
+// malloc.
+//
+// It is a std::pmr::memory_resource, so pmr containers can use it:
+//
+//   std::pmr::vector<int> scratch(&arena);
+//
+// Memory is only valid until the next reset(). Destructors of objects
+// placed in the arena are not run by it.
+class BumpArena : public std::pmr::memory_resource {
+    struct Block {
+        Block      *next;
+        std::size_t size;  // Usable bytes after the header
+    };
+
+public:
+    static constexpr std::size_t kDefaultBlockSize = 64 * 1024;
+
+    explicit BumpArena(std::size_t block_size = kDefaultBlockSize) :
+        block_size_(block_size) {}
+
+    BumpArena(const BumpArena &)            = delete;
+    BumpArena &operator=(const BumpArena &) = delete;
+
+    ~BumpArena() override {
+        release(head_);
+    }
+
+    // Invalidate every allocation and rewind to the start of the arena.
+    void reset() {
+        if (used_ == 0) {
+            return;
+        }
+        used_ = 0;
+        if (head_->next != nullptr) {
+            std::size_t total = capacity();
+            release(head_);
+            head_ = new_block(total, nullptr);
+        }
+        cursor_ = data(head_);
+        end_    = cursor_ + head_->size;
+    }
+
+    // Bytes handed out since the last reset, including alignment padding.
+    std::size_t used() const noexcept {
+        return used_;
+    }
+
+    // Bytes the arena can serve without allocating another block.
+    std::size_t capacity() const noexcept {
+        std::size_t total = 0;
+        for (Block *block = head_; block != nullptr; block = block->next) {
+            total += block->size;
+        }
+        return total;
+    }
+
+private:
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        std::size_t padding = pad(cursor_, alignment);
+        if (cursor_ == nullptr ||
+            bytes + padding > static_cast<std::size_t>(end_ - cursor_)) {
+            // Room for the worst-case padding in the new block.
+            std::size_t need = bytes + alignment;
+            head_   = new_block(need > block_size_ ? need : block_size_,
+                              head_);
+            cursor_ = data(head_);
+            end_    = cursor_ + head_->size;
+            padding = pad(cursor_, alignment);
+        }
+        void *result = cursor_ + padding;
+        cursor_ += padding + bytes;
+        used_ += padding + bytes;
+        return result;
+    }
+
+    void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(
+        const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+    static std::size_t pad(const std::byte *cursor, std::size_t alignment) {
+        auto address = reinterpret_cast<std::uintptr_t>(cursor);
+        return (alignment - address % alignment) % alignment;
+    }
+
+    static std::byte *data(Block *block) {
+        return reinterpret_cast<std::byte *>(block + 1);
+    }
+
+    static Block *new_block(std::size_t size, Block *next) {
+        void *memory = ::operator new(sizeof(Block) + size);
+        return ::new (memory) Block {next, size};
+    }
+
+    static void release(Block *block) {
+        while (block != nullptr) {
+            ::operator delete(std::exchange(block, block->next));
+        }
+    }
+
+    std::size_t block_size_;
+    Block      *head_   = nullptr;
+    std::byte  *cursor_ = nullptr;
+    std::byte  *end_    = nullptr;
+    std::size_t used_   = 0;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_BUMP_ARENA_H
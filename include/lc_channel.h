@@ -0,0 +1,654 @@
+#ifndef LC_CHANNEL_H
+#define LC_CHANNEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "lc_config.h"
+#include "lc_futex.h"
+#include "lc_mpmc_queue.h"
+
+LC_NAMESPACE_BEGIN
+
+// One blocked operation, possibly registered with several channels (by
+// select()). Channels arbitrate through claim(): the one that completes it
+// fires it, every other registration is skipped. Thread waiters park on
+// the state word; coroutine waiters carry a resume callback instead.
+class ChannelWaiter {
+public:
+    ChannelWaiter() = default;
+
+    explicit ChannelWaiter(std::function<void()> resume) :
+        resume_(std::move(resume)) {}
+
+    ChannelWaiter(const ChannelWaiter &)            = delete;
+    ChannelWaiter &operator=(const ChannelWaiter &) = delete;
+
+    // Reserve the waiter while its channel checks for an item. Fails if
+    // another channel already completed it; waits out a concurrent claim,
+    // which may be given back.
+    bool claim() {
+        uint32_t state = kWaiting;
+        while (!state_.compare_exchange_weak(state,
+                                             kClaimed,
+                                             std::memory_order_acquire)) {
+            if (state == kDone) {
+                return false;
+            }
+            state = kWaiting;
+            cpu_relax();
+        }
+        return true;
+    }
+
+    void unclaim() {
+        state_.store(kWaiting, std::memory_order_release);
+    }
+
+    // Mark a claimed waiter as fired by registration `index`, without
+    // waking it. Used when the waiting side completes itself.
+    void finish(size_t index) {
+        fired_ = index;
+        state_.store(kDone, std::memory_order_release);
+    }
+
+    // Fire a claimed waiter and wake or resume it. The waiter may be gone
+    // as soon as the state is published, so nothing of it is touched after.
+    void complete(size_t index) {
+        auto resume = std::move(resume_);
+        fired_      = index;
+        state_.store(kDone, std::memory_order_release);
+        if (resume) {
+            resume();
+        } else {
+            futex_wake(state_, 1);
+        }
+    }
+
+    void wait() {
+        uint32_t state;
+        while ((state = state_.load(std::memory_order_acquire)) != kDone) {
+            futex_wait(state_, state);
+        }
+    }
+
+    bool done() const {
+        return state_.load(std::memory_order_acquire) == kDone;
+    }
+
+    size_t fired() const {
+        return fired_;
+    }
+
+private:
+    static constexpr uint32_t kWaiting = 0;
+    static constexpr uint32_t kClaimed = 1;
+    static constexpr uint32_t kDone    = 2;
+
+    std::atomic<uint32_t> state_ {kWaiting};
+    size_t                fired_ = 0;
+    std::function<void()> resume_;
+};
+
+enum class ChannelMode {
+    Bounded,    // send blocks while `capacity` items are queued
+    Unbounded,  // send never blocks; `capacity` is the lock-free ring size
+};
+
+// Go-style channel. Items travel through an MPMCQueue; the channel mutex is
+// only taken when somebody has to wait, and a parked receiver (or sender)
+// gets its item handed over directly by the thread that makes one
+// available. An unbounded channel spills to a locked list while its ring
+// is full and moves items back as the ring drains, preserving FIFO order.
+//
+// Blocking calls park the calling thread; the *_async() awaiters park a
+// coroutine instead and resume it on an executor (e.g. a ThreadPool), so
+// waiting on a channel does not hold a worker.
+template <typename Tp_>
+class Channel {
+    struct RecvNode {
+        ChannelWaiter     *waiter;
+        size_t             index;
+        std::optional<Tp_> item;
+    };
+
+    struct SendNode {
+        ChannelWaiter *waiter;
+        size_t         index;
+        Tp_           *item;
+        bool           sent;
+    };
+
+    template <typename Up_, typename Func>
+    friend class ChannelRecvCase;
+
+public:
+
+    explicit Channel(std::size_t capacity,
+                     ChannelMode mode = ChannelMode::Bounded) :
+        queue_(capacity), unbounded_(mode == ChannelMode::Unbounded) {}
+
+    Channel(const Channel &)            = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    // Blocks while a bounded channel is full. Returns false if the channel
+    // is closed.
+    bool send(Tp_ value) {
+        if (closed()) {
+            return false;
+        }
+        if (put(value)) {
+            wake_receivers();
+            return true;
+        }
+        ChannelWaiter waiter;
+        SendNode      node {&waiter, 0, &value, false};
+        if (park_sender(node)) {
+            waiter.wait();
+        }
+        return node.sent;
+    }
+
+    // Returns false if the channel is full or closed; `value` is then left
+    // untouched.
+    [[nodiscard]] bool try_send(Tp_ &value) {
+        if (closed() || !put(value)) {
+            return false;
+        }
+        wake_receivers();
+        return true;
+    }
+
+    // Blocks while the channel is empty. Returns nothing once the channel
+    // is closed and drained.
+    std::optional<Tp_> recv() {
+        if (auto item = try_recv()) {
+            return item;
+        }
+        ChannelWaiter waiter;
+        RecvNode      node {&waiter, 0, std::nullopt};
+        if (park_receiver(node)) {
+            waiter.wait();
+        }
+        return std::move(node.item);
+    }
+
+    std::optional<Tp_> try_recv() {
+        auto item = take();
+        if (item) {
+            wake_senders();
+        }
+        return item;
+    }
+
+    // Wake everyone: parked senders fail, receivers drain what is queued
+    // and then get nothing. Sends after close() fail.
+    void close() {
+        Fired fired;
+        {
+            std::scoped_lock<std::mutex> lock(mtx_);
+            closed_.store(true, std::memory_order_seq_cst);
+            dispatch_locked(fired);
+        }
+        complete_all(fired);
+    }
+
+    bool closed() const {
+        return closed_.load(std::memory_order_acquire);
+    }
+
+    // Queued items; approximate while the channel is in use.
+    std::size_t size() const {
+        return queue_.size() + overflow_size_.load(std::memory_order_relaxed);
+    }
+
+    // Range-for support: iterates until the channel is closed and drained.
+    class iterator {
+    public:
+        using value_type      = Tp_;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        explicit iterator(Channel *channel) :
+            channel_(channel), item_(channel->recv()) {}
+
+        Tp_ &operator*() {
+            return *item_;
+        }
+
+        iterator &operator++() {
+            item_ = channel_->recv();
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const {
+            return !item_.has_value();
+        }
+
+    private:
+        Channel           *channel_ = nullptr;
+        std::optional<Tp_> item_;
+    };
+
+    iterator begin() {
+        return iterator(this);
+    }
+
+    std::default_sentinel_t end() {
+        return {};
+    }
+
+    // `co_await channel.recv_async(pool)` waits for an item without
+    // blocking the thread; the coroutine is resumed through
+    // `executor.submit()` when one arrives, or inline on the sending thread
+    // if the executor rejects it.
+    template <typename Executor>
+    class RecvAwaiter {
+    public:
+        RecvAwaiter(Channel &channel, Executor &executor) :
+            channel_(channel), executor_(executor) {}
+
+        bool await_ready() {
+            node_.item = channel_.try_recv();
+            return node_.item.has_value();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            waiter_.emplace([&executor = executor_, handle] {
+                resume_via(executor, handle);
+            });
+            node_.waiter = &*waiter_;
+            return channel_.park_receiver(node_);
+        }
+
+        std::optional<Tp_> await_resume() {
+            return std::move(node_.item);
+        }
+
+    private:
+        Channel                     &channel_;
+        Executor                    &executor_;
+        std::optional<ChannelWaiter> waiter_;
+        RecvNode                     node_ {nullptr, 0, std::nullopt};
+    };
+
+    // `co_await channel.send_async(pool, value)` waits for room without
+    // blocking the thread. Yields false if the channel is closed.
+    template <typename Executor>
+    class SendAwaiter {
+    public:
+        SendAwaiter(Channel &channel, Executor &executor, Tp_ value) :
+            channel_(channel), executor_(executor), value_(std::move(value)) {}
+
+        bool await_ready() {
+            node_.sent = channel_.try_send(value_);
+            return node_.sent;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            waiter_.emplace([&executor = executor_, handle] {
+                resume_via(executor, handle);
+            });
+            node_.waiter = &*waiter_;
+            node_.item   = &value_;
+            return channel_.park_sender(node_);
+        }
+
+        bool await_resume() const {
+            return node_.sent;
+        }
+
+    private:
+        Channel                     &channel_;
+        Executor                    &executor_;
+        Tp_                          value_;
+        std::optional<ChannelWaiter> waiter_;
+        SendNode                     node_ {nullptr, 0, nullptr, false};
+    };
+
+    template <typename Executor>
+    RecvAwaiter<Executor> recv_async(Executor &executor) {
+        return RecvAwaiter<Executor>(*this, executor);
+    }
+
+    template <typename Executor>
+    SendAwaiter<Executor> send_async(Executor &executor, Tp_ value) {
+        return SendAwaiter<Executor>(*this, executor, std::move(value));
+    }
+
+private:
+
+    using Fired = std::vector<std::pair<ChannelWaiter *, size_t>>;
+
+    // Runs on whichever thread completes the waiter, after the item has
+    // changed hands, so it must not throw: if the executor rejects the
+    // task (e.g. a full pool queue) the coroutine is resumed inline.
+    template <typename Executor>
+    static void resume_via(Executor &executor, std::coroutine_handle<> handle) {
+        try {
+            executor.submit([handle] { handle.resume(); });
+        } catch (...) {
+            handle.resume();
+        }
+    }
+
+    // Queue `value` without waiting; it is only moved from on success.
+    bool put(Tp_ &value) {
+        if (unbounded_ && overflow_size_.load(std::memory_order_acquire)) {
+            std::scoped_lock<std::mutex> lock(mtx_);
+            return put_locked(value);
+        }
+        if (queue_.enqueue(std::move(value))) {
+            return true;
+        }
+        if (!unbounded_) {
+            return false;
+        }
+        std::scoped_lock<std::mutex> lock(mtx_);
+        return put_locked(value);
+    }
+
+    bool put_locked(Tp_ &value) {
+        if (!unbounded_) {
+            return queue_.enqueue(std::move(value));
+        }
+        refill_locked();
+        if (overflow_.empty() && queue_.enqueue(std::move(value))) {
+            return true;
+        }
+        overflow_.push_back(std::move(value));
+        overflow_size_.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<Tp_> take() {
+        if (std::optional<Tp_> item = queue_.try_dequeue()) {
+            if (unbounded_ && overflow_size_.load(std::memory_order_acquire)) {
+                std::scoped_lock<std::mutex> lock(mtx_);
+                refill_locked();
+            }
+            return item;
+        }
+        if (unbounded_ && overflow_size_.load(std::memory_order_acquire)) {
+            std::scoped_lock<std::mutex> lock(mtx_);
+            return take_locked();
+        }
+        return std::nullopt;
+    }
+
+    std::optional<Tp_> take_locked() {
+        if (std::optional<Tp_> item = queue_.try_dequeue()) {
+            refill_locked();
+            return item;
+        }
+        if (!overflow_.empty()) {
+            std::optional<Tp_> item(std::move(overflow_.front()));
+            overflow_.pop_front();
+            overflow_size_.fetch_sub(1, std::memory_order_release);
+            return item;
+        }
+        return std::nullopt;
+    }
+
+    // Move spilled items into the ring, oldest first.
+    void refill_locked() {
+        while (!overflow_.empty() &&
+               queue_.enqueue(std::move(overflow_.front()))) {
+            overflow_.pop_front();
+            overflow_size_.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    // Register `node` and serve the waiters in order. Returns false if the
+    // node was completed on the spot, in which case nobody will wake it.
+    bool park_receiver(RecvNode &node) {
+        Fired fired;
+        bool  parked = true;
+        {
+            std::scoped_lock<std::mutex> lock(mtx_);
+            receivers_.push_back(&node);
+            receivers_waiting_.store(receivers_.size(),
+                                     std::memory_order_relaxed);
+            // Pairs with the fence in wake_receivers().
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            dispatch_locked(fired);
+            parked = !take_own(fired, node.waiter);
+        }
+        complete_all(fired);
+        return parked;
+    }
+
+    bool park_sender(SendNode &node) {
+        Fired fired;
+        bool  parked = true;
+        {
+            std::scoped_lock<std::mutex> lock(mtx_);
+            senders_.push_back(&node);
+            senders_waiting_.store(senders_.size(), std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            dispatch_locked(fired);
+            parked = !take_own(fired, node.waiter);
+        }
+        complete_all(fired);
+        return parked;
+    }
+
+    // Removes `waiter` from `fired` and marks it done in place.
+    static bool take_own(Fired &fired, ChannelWaiter *waiter) {
+        auto it = std::find_if(fired.begin(), fired.end(), [&](auto &f) {
+            return f.first == waiter;
+        });
+        if (it == fired.end()) {
+            return false;
+        }
+        waiter->finish(it->second);
+        fired.erase(it);
+        return true;
+    }
+
+    static void complete_all(Fired &fired) {
+        for (auto &[waiter, index] : fired) {
+            waiter->complete(index);
+        }
+    }
+
+    void wake_receivers() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (receivers_waiting_.load(std::memory_order_relaxed) != 0) {
+            dispatch();
+        }
+    }
+
+    void wake_senders() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (senders_waiting_.load(std::memory_order_relaxed) != 0) {
+            dispatch();
+        }
+    }
+
+    void dispatch() {
+        Fired fired;
+        {
+            std::scoped_lock<std::mutex> lock(mtx_);
+            dispatch_locked(fired);
+        }
+        complete_all(fired);
+    }
+
+    // Hand items between the queue and parked waiters. Claimed waiters are
+    // collected in `fired` and completed after the lock is released.
+    // Receivers freeing room can let senders in and the other way round, so
+    // it loops until neither side moves.
+    void dispatch_locked(Fired &fired) {
+        bool closed   = closed_.load(std::memory_order_relaxed);
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            while (!senders_.empty()) {
+                SendNode *node = senders_.front();
+                if (!node->waiter->claim()) {
+                    senders_.pop_front();  // Fired by another channel
+                    continue;
+                }
+                if (!closed && !put_locked(*node->item)) {
+                    node->waiter->unclaim();
+                    break;
+                }
+                node->sent = !closed;
+                senders_.pop_front();
+                fired.emplace_back(node->waiter, node->index);
+                progress = true;
+            }
+            while (!receivers_.empty()) {
+                RecvNode *node = receivers_.front();
+                if (!node->waiter->claim()) {
+                    receivers_.pop_front();
+                    continue;
+                }
+                node->item = take_locked();
+                if (!node->item && !closed) {
+                    node->waiter->unclaim();
+                    break;
+                }
+                receivers_.pop_front();
+                fired.emplace_back(node->waiter, node->index);
+                progress = true;
+            }
+        }
+        senders_waiting_.store(senders_.size(), std::memory_order_relaxed);
+        receivers_waiting_.store(receivers_.size(), std::memory_order_relaxed);
+    }
+
+    // Drop a registration that did not fire, e.g. the losing cases of a
+    // select().
+    void unpark_receiver(RecvNode &node) {
+        std::scoped_lock<std::mutex> lock(mtx_);
+        std::erase(receivers_, &node);
+        receivers_waiting_.store(receivers_.size(), std::memory_order_relaxed);
+    }
+
+    MPMCQueue<Tp_>         queue_;
+    const bool             unbounded_;
+    std::atomic<bool>      closed_ {false};
+    std::atomic<size_t>    overflow_size_ {0};
+    std::mutex             mtx_;
+    std::deque<Tp_>        overflow_;
+    std::deque<RecvNode *> receivers_;
+    std::deque<SendNode *> senders_;
+    alignas(64) std::atomic<size_t> receivers_waiting_ {0};
+    std::atomic<size_t>             senders_waiting_ {0};
+};
+
+// A receive case for select(): `handler` is called with the received item,
+// or with an empty optional if the channel is closed and drained.
+template <typename Tp_, typename Func>
+class ChannelRecvCase {
+public:
+    ChannelRecvCase(Channel<Tp_> &channel, Func handler) :
+        channel_(channel), handler_(std::move(handler)) {}
+
+private:
+    template <typename... Cases>
+    friend size_t select(Cases &&...cases);
+
+    using Node = typename Channel<Tp_>::RecvNode;
+
+    bool try_fire() {
+        auto item = channel_.try_recv();
+        if (!item && !channel_.closed()) {
+            return false;
+        }
+        if (!item) {
+            item = channel_.try_recv();  // Sent just before the close
+        }
+        handler_(std::move(item));
+        return true;
+    }
+
+    void park(ChannelWaiter &waiter, size_t index) {
+        node_.waiter = &waiter;
+        node_.index  = index;
+        channel_.park_receiver(node_);
+    }
+
+    void unpark() {
+        channel_.unpark_receiver(node_);
+    }
+
+    void fire() {
+        handler_(std::move(node_.item));
+    }
+
+    Channel<Tp_> &channel_;
+    Func          handler_;
+    Node          node_ {nullptr, 0, std::nullopt};
+};
+
+template <typename Tp_, typename Func>
+ChannelRecvCase<Tp_, Func> on_recv(Channel<Tp_> &channel, Func handler) {
+    return ChannelRecvCase<Tp_, Func>(channel, std::move(handler));
+}
+
+// Wait until one of the receive cases is ready, run its handler and return
+// its index. Ready cases are tried in argument order.
+template <typename... Cases>
+size_t select(Cases &&...cases) {
+    static_assert(sizeof...(Cases) > 0, "select() needs at least one case");
+    constexpr size_t kNone = sizeof...(Cases);
+
+    size_t ready = kNone;
+    size_t index = 0;
+    auto   poll  = [&](auto &c) {
+        if (ready == kNone && c.try_fire()) {
+            ready = index;
+        }
+        ++index;
+    };
+    (poll(cases), ...);
+    if (ready != kNone) {
+        return ready;
+    }
+
+    // Park on every channel; one registration may fire while the later
+    // ones are being made, and those are then skipped.
+    ChannelWaiter waiter;
+    index     = 0;
+    auto park = [&](auto &c) {
+        if (!waiter.done()) {
+            c.park(waiter, index);
+        }
+        ++index;
+    };
+    (park(cases), ...);
+    waiter.wait();
+    (cases.unpark(), ...);
+
+    ready     = waiter.fired();
+    index     = 0;
+    auto fire = [&](auto &c) {
+        if (index++ == ready) {
+            c.fire();
+        }
+    };
+    (fire(cases), ...);
+    return ready;
+}
+
+LC_NAMESPACE_END
+
+#endif  // LC_CHANNEL_H
@@ -0,0 +1,91 @@
+#ifndef LC_CODEL_H
+#define LC_CODEL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+struct CodelOptions {
+    std::chrono::nanoseconds target_delay = std::chrono::milliseconds(5);
+    std::chrono::nanoseconds interval     = std::chrono::milliseconds(100);
+};
+
+// Queue-delay based load shedding after CoDel, in the variant used by RPC
+// servers: if the smallest sojourn time of the tasks dequeued during an
+// interval stayed above `target_delay`, the queue is treated as overloaded
+// for the next interval and every task that waited longer than twice the
+// target is dropped. Only dequeued tasks are measured, so a queue where at
+// least one task per interval gets through quickly is not considered
+// overloaded, however long its bursts are.
+//
+// should_drop() is called by every consumer; the first sample past an
+// interval's deadline closes it through a CAS. If no sample arrived for a
+// whole interval after that, the old verdict is stale and the next window
+// starts out not overloaded.
+class Codel {
+public:
+
+    explicit Codel(const CodelOptions &options = {}) :
+        target_ns_(options.target_delay.count()),
+        interval_ns_(options.interval.count()) {
+        if (target_ns_ <= 0 || interval_ns_ <= 0) {
+            throw std::invalid_argument(
+                "CoDel target delay and interval must be positive.");
+        }
+        interval_end_ns_.store(0, std::memory_order_relaxed);
+        min_delay_ns_.store(0, std::memory_order_relaxed);
+        overloaded_.store(false, std::memory_order_relaxed);
+    }
+
+    Codel(const Codel &)            = delete;
+    Codel &operator=(const Codel &) = delete;
+
+    // Record a task dequeued at `now_ns` (steady clock) after waiting
+    // `sojourn`, and return true if it should be dropped.
+    [[nodiscard]] bool should_drop(int64_t                  now_ns,
+                                   std::chrono::nanoseconds sojourn) {
+        int64_t delay = sojourn.count();
+        int64_t end   = interval_end_ns_.load(std::memory_order_relaxed);
+        if (now_ns >= end &&
+            interval_end_ns_.compare_exchange_strong(
+                end,
+                now_ns + interval_ns_,
+                std::memory_order_relaxed)) {
+            // The first sample of an interval starts its minimum and is
+            // never dropped.
+            int64_t min = min_delay_ns_.exchange(delay,
+                                                 std::memory_order_relaxed);
+            bool    idle_gap = now_ns - end > interval_ns_;
+            overloaded_.store(!idle_gap && min > target_ns_,
+                              std::memory_order_relaxed);
+            return false;
+        }
+        int64_t min = min_delay_ns_.load(std::memory_order_relaxed);
+        while (delay < min && !min_delay_ns_.compare_exchange_weak(
+                                  min,
+                                  delay,
+                                  std::memory_order_relaxed)) {}
+        return delay > 2 * target_ns_ &&
+               overloaded_.load(std::memory_order_relaxed);
+    }
+
+    bool overloaded() const {
+        return overloaded_.load(std::memory_order_relaxed);
+    }
+
+private:
+    const int64_t                    target_ns_;
+    const int64_t                    interval_ns_;
+    alignas(64) std::atomic<int64_t> interval_end_ns_;
+    std::atomic<int64_t>             min_delay_ns_;
+    std::atomic<bool>                overloaded_;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_CODEL_H
@@ -0,0 +1,88 @@
+#ifndef LC_CONCURRENCY_LIMITER_H
+#define LC_CONCURRENCY_LIMITER_H
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+// Caps how many tasks of one class execute at once without blocking the
+// workers that pick them up. A task over the limit is parked in a side
+// queue, and the worker that finishes a task of the class takes the parked
+// one over directly, so the slot never goes back to the pool.
+//
+// `inflight_` counts running and parked tasks together: admit() runs the
+// task if the count was below the limit, and release() hands the slot to a
+// parked task if the count was above it. The side queue is only touched on
+// the over-limit path.
+template <typename Task>
+class ConcurrencyLimiter {
+public:
+
+    explicit ConcurrencyLimiter(std::size_t limit) : limit_(limit) {
+        if (limit == 0) {
+            throw std::invalid_argument("Concurrency limit must be positive.");
+        }
+        inflight_.store(0, std::memory_order_relaxed);
+    }
+
+    ConcurrencyLimiter(const ConcurrencyLimiter &)            = delete;
+    ConcurrencyLimiter &operator=(const ConcurrencyLimiter &) = delete;
+
+    // Returns true if `task` may run now; otherwise it has been parked.
+    [[nodiscard]] bool admit(Task &task) {
+        if (inflight_.fetch_add(1, std::memory_order_acq_rel) < limit_) {
+            return true;
+        }
+        std::scoped_lock<std::mutex> lock(mtx_);
+        parked_.push_back(std::move(task));
+        return false;
+    }
+
+    // Call once an admitted task finished. Returns true with a parked task
+    // moved into `next` if one inherits the slot; the caller runs it and
+    // calls release() again afterwards.
+    [[nodiscard]] bool release(Task &next) {
+        if (inflight_.fetch_sub(1, std::memory_order_acq_rel) <= limit_) {
+            return false;
+        }
+        // The task we counted may still be on its way into the side queue.
+        while (true) {
+            {
+                std::scoped_lock<std::mutex> lock(mtx_);
+                if (!parked_.empty()) {
+                    next = std::move(parked_.front());
+                    parked_.pop_front();
+                    return true;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    std::size_t limit() const {
+        return limit_;
+    }
+
+    // Running plus parked tasks; approximate while tasks are in flight.
+    std::size_t inflight() const {
+        return inflight_.load(std::memory_order_relaxed);
+    }
+
+private:
+    const std::size_t               limit_;
+    alignas(64) std::atomic<size_t> inflight_;
+    std::mutex                      mtx_;
+    std::deque<Task>                parked_;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_CONCURRENCY_LIMITER_H
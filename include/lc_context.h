@@ -1,6 +1,10 @@
 #ifndef LC_CONTEXT_H
 #define LC_CONTEXT_H
 
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <type_traits>
 
 #include "lc_config.h"
@@ -12,10 +16,27 @@ template <typename Metadata, typename Data>
 struct Context {
     Metadata metadata;
     Data     data;
+    int64_t  enqueued_ns = 0;  // steady clock; 0 unless the pool tracks it
 };
 
 struct EmptyMetadata {};
 
+// Metadata naming the class a task belongs to, e.g. for per-class limits.
+template <typename Metadata>
+concept ClassifiedMetadata = requires(const Metadata &metadata) {
+    { metadata.task_class } -> std::convertible_to<std::size_t>;
+};
+
+// Metadata carrying a hashable key for tasks that should share a worker,
+// e.g. the shard of an index they touch.
+template <typename Metadata>
+concept AffinityMetadata = requires(const Metadata &metadata) {
+    {
+        std::hash<std::remove_cvref_t<decltype(metadata.affinity_key)>> {}(
+            metadata.affinity_key)
+    } -> std::convertible_to<std::size_t>;
+};
+
 LC_NAMESPACE_END
 
 #endif  // LC_CONTEXT_H
@@ -0,0 +1,424 @@
+#ifndef LC_CORE_EXECUTOR_H
+#define LC_CORE_EXECUTOR_H
+
+#include <array>
+#include <atomic>
+#include <climits>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "lc_config.h"
+#include "lc_futex.h"
+#include "lc_mpmc_queue.h"
+#include "lc_pool_config.h"
+#include "lc_spsc_queue.h"
+
+LC_NAMESPACE_BEGIN
+
+template <size_t Cores, typename Affinity>
+class CoreExecutor;
+
+// Result of CoreExecutor::submit_to_core(). A coroutine that submitted
+// from one of the executor's cores can `co_await` it and resumes on that
+// same core (elsewhere it resumes on the core that ran the work). Other
+// threads call get(), which blocks. Consume it once.
+template <typename Result>
+class CoreFuture {
+    static constexpr uint32_t kDone     = 1;
+    static constexpr uint32_t kAwaiting = 2;  // A coroutine is suspended
+    static constexpr uint32_t kBlocked  = 4;  // A thread sleeps in get()
+
+    using Stored =
+        std::conditional_t<std::is_void_v<Result>, std::monostate, Result>;
+
+    struct State {
+        std::atomic<uint32_t>   flags {0};
+        std::optional<Stored>   value;
+        std::exception_ptr      error;
+        std::coroutine_handle<> waiter;
+        size_t                  origin;  // Core to resume on, or kNoCore
+    };
+
+public:
+    CoreFuture(CoreFuture &&) noexcept            = default;
+    CoreFuture &operator=(CoreFuture &&) noexcept = default;
+
+    bool ready() const {
+        return (state_->flags.load(std::memory_order_acquire) & kDone) != 0;
+    }
+
+    Result get() {
+        uint32_t flags = state_->flags.load(std::memory_order_acquire);
+        while ((flags & kDone) == 0) {
+            if ((flags & kBlocked) == 0) {
+                flags = state_->flags.fetch_or(kBlocked,
+                                               std::memory_order_acq_rel) |
+                        kBlocked;
+                continue;
+            }
+            futex_wait(state_->flags, flags);
+            flags = state_->flags.load(std::memory_order_acquire);
+        }
+        return take();
+    }
+
+    bool await_ready() const {
+        return ready();
+    }
+
+    // Publish the handle before the flag; whoever sets the second of
+    // kDone and kAwaiting decides who resumes the coroutine.
+    bool await_suspend(std::coroutine_handle<> handle) {
+        state_->waiter = handle;
+        return (state_->flags.fetch_or(kAwaiting, std::memory_order_acq_rel) &
+                kDone) == 0;
+    }
+
+    Result await_resume() {
+        return take();
+    }
+
+private:
+    template <size_t, typename>
+    friend class CoreExecutor;
+
+    explicit CoreFuture(std::shared_ptr<State> state) :
+        state_(std::move(state)) {}
+
+    Result take() {
+        if (state_->error) {
+            std::rethrow_exception(state_->error);
+        }
+        if constexpr (!std::is_void_v<Result>) {
+            return std::move(*state_->value);
+        }
+    }
+
+    std::shared_ptr<State> state_;
+};
+
+// Thread-per-core, shared-nothing executor in the style of Seastar. Each
+// core is a thread (pinned by `Affinity`) that owns whatever data it is
+// given, and cores talk only by message: every ordered pair of cores has
+// its own SPSCQueue, so no queue sees more than one writer and one reader
+// and there is no shared injection queue to contend on.
+//
+//   CoreExecutor<4> cores;
+//   auto sum = cores.submit_to_core(2, [] { return local_shard().sum(); });
+//
+// Threads outside the executor submit through a per-core MPMC inbox,
+// which also absorbs overflow when a core-to-core ring is full (messages
+// between a pair of cores are then no longer strictly FIFO). Idle cores
+// spin briefly, then park on a futex until a message arrives.
+template <size_t Cores, typename Affinity = PinnedAffinity>
+class CoreExecutor {
+    static_assert(Cores > 0, "An executor needs at least one core.");
+
+    using Message = std::function<void()>;
+
+    struct alignas(64) Core {
+        std::thread           thread;
+        std::atomic<uint32_t> wake {0};
+        std::atomic<bool>     sleeping {false};
+        std::atomic<bool>     busy {true};  // In a pass over its queues
+        std::atomic<size_t>   completed {0};
+    };
+
+    // Messages run per queue before a core moves on to the next one.
+    static constexpr size_t kBatchSize = 32;
+    // Empty passes before a core parks.
+    static constexpr size_t kSpinPasses = 64;
+
+public:
+    static constexpr size_t kNoCore           = static_cast<size_t>(-1);
+    static constexpr size_t kDefaultQueueSize = 1024;
+
+    // `queue_size` is the capacity of each core-to-core ring and of each
+    // core's inbox, and must be a power of two.
+    explicit CoreExecutor(size_t queue_size = kDefaultQueueSize) {
+        for (size_t to = 0; to < Cores; ++to) {
+            inboxes_[to] = std::make_unique<MPMCQueue<Message>>(queue_size);
+            for (size_t from = 0; from < Cores; ++from) {
+                mesh_[from][to] =
+                    std::make_unique<SPSCQueue<Message>>(queue_size);
+            }
+        }
+        for (size_t i = 0; i < Cores; ++i) {
+            cores_[i].thread =
+                std::thread(&CoreExecutor::core_thread, this, i);
+        }
+    }
+
+    CoreExecutor(const CoreExecutor &)            = delete;
+    CoreExecutor &operator=(const CoreExecutor &) = delete;
+
+    ~CoreExecutor() {
+        shutdown();
+    }
+
+    // Run `func` on core `core`. Throws std::out_of_range for a bad index
+    // and std::runtime_error if the message cannot be queued.
+    template <std::invocable Func>
+    auto submit_to_core(size_t core, Func &&func)
+        -> CoreFuture<std::invoke_result_t<Func>> {
+        using Result = std::invoke_result_t<Func>;
+        using State  = typename CoreFuture<Result>::State;
+
+        if (core >= Cores) {
+            throw std::out_of_range("Core index out of range");
+        }
+        auto state    = std::make_shared<State>();
+        state->origin = this_core();
+        post(core, [this, state, func = std::forward<Func>(func)]() mutable {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    func();
+                    state->value.emplace();
+                } else {
+                    state->value.emplace(func());
+                }
+            } catch (...) {
+                state->error = std::current_exception();
+            }
+            complete<Result>(state);
+        });
+        return CoreFuture<Result>(std::move(state));
+    }
+
+    // Index of the calling core, or kNoCore on other threads.
+    size_t this_core() const {
+        return current_executor_ == this ? current_core_ : kNoCore;
+    }
+
+    static constexpr size_t size() {
+        return Cores;
+    }
+
+    // Let in-flight messages finish, including ones they send on, then
+    // stop the cores. Later submissions from outside throw. Must not be
+    // called from one of the cores.
+    void shutdown() {
+        if (this_core() != kNoCore) {
+            throw std::logic_error("Cannot shut down the executor from one "
+                                   "of its cores");
+        }
+        if (stopping_.exchange(true, std::memory_order_seq_cst)) {
+            return;
+        }
+        while (!quiescent()) {
+            std::this_thread::yield();
+        }
+        exit_.store(true, std::memory_order_seq_cst);
+        for (size_t i = 0; i < Cores; ++i) {
+            wake(i);
+            cores_[i].thread.join();
+        }
+    }
+
+private:
+
+    template <typename Result>
+    void complete(
+        const std::shared_ptr<typename CoreFuture<Result>::State> &state) {
+        using Future   = CoreFuture<Result>;
+        uint32_t flags = state->flags.fetch_or(Future::kDone,
+                                               std::memory_order_acq_rel);
+        if ((flags & Future::kAwaiting) != 0) {
+            size_t origin = state->origin;
+            if (origin == kNoCore || origin == this_core()) {
+                state->waiter.resume();
+            } else {
+                post(origin, [waiter = state->waiter] { waiter.resume(); });
+            }
+        }
+        if ((flags & Future::kBlocked) != 0) {
+            futex_wake(state->flags, INT_MAX);
+        }
+    }
+
+    // From a core: its ring to `to`, spilling into the inbox when full.
+    // Resumptions cannot be dropped, so a core retries rather than fail,
+    // running its own messages meanwhile: the target may itself be stuck
+    // sending to us.
+    void post(size_t to, Message &&message) {
+        size_t from = this_core();
+        if (from == kNoCore) {
+            post_external(to, std::move(message));
+            return;
+        }
+        while (!mesh_[from][to]->enqueue(std::move(message)) &&
+               !inboxes_[to]->enqueue(std::move(message))) {
+            wake(to);
+            if (!poll(from)) {
+                std::this_thread::yield();
+            }
+        }
+        wake(to);
+    }
+
+    // Counted in `posting_` from before the stopping_ check until the
+    // message is queued, so shutdown() cannot find the executor quiescent
+    // in between and let the message go unrun.
+    void post_external(size_t to, Message &&message) {
+        posting_.fetch_add(1, std::memory_order_seq_cst);
+        if (stopping_.load(std::memory_order_seq_cst)) {
+            posting_.fetch_sub(1, std::memory_order_seq_cst);
+            throw std::runtime_error("Executor is shut down");
+        }
+        if (!inboxes_[to]->enqueue(std::move(message))) {
+            posting_.fetch_sub(1, std::memory_order_seq_cst);
+            throw std::runtime_error("Failed to enqueue task");
+        }
+        wake(to);
+        posting_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    // Pairs with park(): either the core sees the message on its re-check
+    // or this sees it sleeping and bumps the word it waits on.
+    void wake(size_t index) {
+        auto &core = cores_[index];
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (core.sleeping.load(std::memory_order_relaxed)) {
+            core.wake.fetch_add(1, std::memory_order_release);
+            futex_wake(core.wake, 1);
+        }
+    }
+
+    void core_thread(size_t index) {
+        auto &core        = cores_[index];
+        current_executor_ = this;
+        current_core_     = index;
+        Affinity::on_worker_start(index);
+        size_t idle = 0;
+        while (!exit_.load(std::memory_order_acquire)) {
+            if (poll(index)) {
+                idle = 0;
+                continue;
+            }
+            // Nothing ran: this pass is over. Shutdown relies on `busy`
+            // being set again before the next pass takes anything.
+            core.busy.store(false, std::memory_order_seq_cst);
+            if (++idle < kSpinPasses) {
+                cpu_relax();
+            } else {
+                park(index);
+                idle = 0;
+            }
+            core.busy.store(true, std::memory_order_seq_cst);
+        }
+    }
+
+    // Run up to kBatchSize messages from each queue addressed to `index`.
+    bool poll(size_t index) {
+        auto  &core = cores_[index];
+        size_t ran  = 0;
+        for (size_t from = 0; from < Cores; ++from) {
+            auto &link = *mesh_[from][index];
+            for (size_t i = 0; i < kBatchSize; ++i) {
+                std::optional<Message> message = link.try_dequeue();
+                if (!message) {
+                    break;
+                }
+                (*message)();
+                ++ran;
+            }
+        }
+        for (size_t i = 0; i < kBatchSize; ++i) {
+            std::optional<Message> message = inboxes_[index]->try_dequeue();
+            if (!message) {
+                break;
+            }
+            (*message)();
+            ++ran;
+        }
+        if (ran != 0) {
+            core.completed.fetch_add(ran, std::memory_order_seq_cst);
+        }
+        return ran != 0;
+    }
+
+    bool has_messages(size_t index) const {
+        for (size_t from = 0; from < Cores; ++from) {
+            if (!mesh_[from][index]->empty()) {
+                return true;
+            }
+        }
+        return !inboxes_[index]->empty();
+    }
+
+    void park(size_t index) {
+        auto    &core = cores_[index];
+        uint32_t seen = core.wake.load(std::memory_order_acquire);
+        core.sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!has_messages(index) && !exit_.load(std::memory_order_relaxed)) {
+            futex_wait(core.wake, seen);
+        }
+        core.sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    // True once no message is queued or running and none can appear: no
+    // outside post was in flight, no core was mid-pass on either check,
+    // every queue was empty in between, and no core completed anything
+    // meanwhile (so none could have sent).
+    bool quiescent() const {
+        if (posting_.load(std::memory_order_seq_cst) != 0) {
+            return false;
+        }
+        size_t before = total_completed();
+        if (any_busy()) {
+            return false;
+        }
+        for (size_t i = 0; i < Cores; ++i) {
+            if (has_messages(i)) {
+                return false;
+            }
+        }
+        return !any_busy() && total_completed() == before;
+    }
+
+    bool any_busy() const {
+        for (const auto &core : cores_) {
+            if (core.busy.load(std::memory_order_seq_cst)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t total_completed() const {
+        size_t total = 0;
+        for (const auto &core : cores_) {
+            total += core.completed.load(std::memory_order_seq_cst);
+        }
+        return total;
+    }
+
+    std::array<Core, Cores> cores_;
+    // mesh_[from][to] is written only by core `from`, read only by `to`.
+    std::array<std::array<std::unique_ptr<SPSCQueue<Message>>, Cores>, Cores>
+        mesh_;
+    std::array<std::unique_ptr<MPMCQueue<Message>>, Cores> inboxes_;
+    std::atomic<size_t>                                    posting_ {0};
+    std::atomic<bool>                                      stopping_ {false};
+    std::atomic<bool>                                      exit_ {false};
+
+    static inline LC_THREAD_LOCAL const CoreExecutor *current_executor_ =
+        nullptr;
+    static inline LC_THREAD_LOCAL size_t current_core_ = kNoCore;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_CORE_EXECUTOR_H
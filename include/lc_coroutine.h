@@ -0,0 +1,65 @@
+#ifndef LC_COROUTINE_H
+#define LC_COROUTINE_H
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+// Return type for fire-and-forget coroutines: the coroutine starts running
+// on the calling thread and frees itself when it finishes. An exception
+// escaping it terminates the program, as with a std::thread.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+};
+
+// `co_await resume_on(pool)` continues the coroutine on one of the pool's
+// workers. Works with anything that has a submit(func) member.
+template <typename Executor>
+class ResumeOn {
+public:
+    explicit ResumeOn(Executor &executor) : executor_(executor) {}
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        executor_.submit([handle] { handle.resume(); });
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    Executor &executor_;
+};
+
+template <typename Executor>
+ResumeOn<Executor> resume_on(Executor &executor) {
+    return ResumeOn<Executor>(executor);
+}
+
+LC_NAMESPACE_END
+
+#endif  // LC_COROUTINE_H
@@ -0,0 +1,181 @@
+#ifndef LC_DWCAS_QUEUE_H
+#define LC_DWCAS_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+// Bounded MPMC ring for pointer-sized payloads in which each slot packs its
+// sequence number and its value into one 16-byte word, updated with a
+// double-width CAS (cmpxchg16b on x86-64, casp or libatomic elsewhere).
+//
+// In MPMCQueue a producer first claims a cell by bumping the index, then
+// writes the value, then publishes the sequence, and a consumer that reaches
+// a claimed but unpublished cell has to wait for that producer. Here a
+// single CAS on the slot claims and publishes at once, so the shared
+// indices are only hints that any thread may advance, and a producer or
+// consumer preempted mid-operation never stalls the others.
+//
+// x86-64 needs no compiler flags (the CAS is inline assembly); other
+// targets go through __atomic builtins and may need libatomic, which the
+// build links when it finds it.
+template <typename Tp_>
+    requires std::is_trivially_copyable_v<Tp_> &&
+             (sizeof(Tp_) <= sizeof(uint64_t))
+class DWCASQueue {
+    struct Word {
+        uint64_t sequence;
+        uint64_t value;
+    };
+
+    struct alignas(64) Slot {
+        alignas(16) Word word;
+    };
+
+public:
+
+    explicit DWCASQueue(std::size_t queue_size) :
+        pool_mask_(queue_size - 1),
+        pool_(std::make_unique<Slot[]>(queue_size)) {
+        if (queue_size < 2 || (queue_size & pool_mask_) != 0) {
+            throw std::invalid_argument("Queue size must be a power of two.");
+        }
+        for (std::size_t i = 0; i < queue_size; ++i) {
+            pool_[i].word = {i, 0};
+        }
+        enqueue_index_.store(0, std::memory_order_relaxed);
+        dequeue_index_.store(0, std::memory_order_relaxed);
+    }
+
+    DWCASQueue(const DWCASQueue &)            = delete;
+    DWCASQueue &operator=(const DWCASQueue &) = delete;
+
+    [[nodiscard]] bool enqueue(Tp_ value) {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(Tp_));
+        uint64_t pos = enqueue_index_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot    &slot = pool_[pos & pool_mask_];
+            Word     seen = load(slot);
+            intptr_t diff = (intptr_t)seen.sequence - (intptr_t)pos;
+            if (diff == 0) {
+                if (cas(slot, seen, {pos + 1, bits})) {
+                    advance(enqueue_index_, pos);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Queue is full
+            } else if (diff == 1) {
+                // Filled by a producer that has not moved the index yet.
+                advance(enqueue_index_, pos);
+            }
+            pos = enqueue_index_.load(std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]] bool dequeue(Tp_ &value) {
+        uint64_t pos = dequeue_index_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot    &slot = pool_[pos & pool_mask_];
+            Word     seen = load(slot);
+            intptr_t diff = (intptr_t)seen.sequence - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (cas(slot, seen, {pos + pool_mask_ + 1, seen.value})) {
+                    advance(dequeue_index_, pos);
+                    std::memcpy(&value, &seen.value, sizeof(Tp_));
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Queue is empty
+            } else if (diff == (intptr_t)pool_mask_) {
+                // Emptied by a consumer that has not moved the index yet.
+                advance(dequeue_index_, pos);
+            }
+            pos = dequeue_index_.load(std::memory_order_relaxed);
+        }
+    }
+
+    std::optional<Tp_> try_dequeue() {
+        Tp_ value;
+        if (!dequeue(value)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    std::size_t capacity() const {
+        return pool_mask_ + 1;
+    }
+
+    // A snapshot, as with MPMCQueue::size(). The indices may trail the
+    // slots by one pending help step per side.
+    std::size_t size() const {
+        uint64_t tail = dequeue_index_.load(std::memory_order_acquire);
+        uint64_t head = enqueue_index_.load(std::memory_order_acquire);
+        return head > tail ? std::min<std::size_t>(head - tail, capacity())
+                           : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+private:
+
+    // The halves are read separately; a torn pair simply fails the CAS.
+    static Word load(Slot &slot) {
+        Word word;
+        word.sequence = std::atomic_ref<uint64_t>(slot.word.sequence)
+                            .load(std::memory_order_acquire);
+        word.value = std::atomic_ref<uint64_t>(slot.word.value)
+                         .load(std::memory_order_relaxed);
+        return word;
+    }
+
+    static bool cas(Slot &slot, Word expected, Word desired) {
+#if defined(__x86_64__)
+        bool swapped;
+        asm volatile("lock cmpxchg16b %1"
+                     : "=@ccz"(swapped),
+                       "+m"(slot.word),
+                       "+a"(expected.sequence),
+                       "+d"(expected.value)
+                     : "b"(desired.sequence), "c"(desired.value)
+                     : "memory");
+        return swapped;
+#else
+        return __atomic_compare_exchange(&slot.word,
+                                         &expected,
+                                         &desired,
+                                         false,
+                                         __ATOMIC_ACQ_REL,
+                                         __ATOMIC_ACQUIRE);
+#endif
+    }
+
+    // Move `index` past `pos` unless somebody already did.
+    static void advance(std::atomic<uint64_t> &index, uint64_t pos) {
+        index.compare_exchange_strong(pos,
+                                      pos + 1,
+                                      std::memory_order_relaxed);
+    }
+
+    const std::size_t       pool_mask_;
+    std::unique_ptr<Slot[]> pool_;
+    alignas(64) std::atomic<uint64_t> enqueue_index_;
+    alignas(64) std::atomic<uint64_t> dequeue_index_;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_DWCAS_QUEUE_H
@@ -0,0 +1,112 @@
+#ifndef LC_FUTEX_H
+#define LC_FUTEX_H
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#include "lc_config.h"
+
+#if defined(LC_PLATFORM_LINUX)
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+
+#  include <cerrno>
+#  include <ctime>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  include <immintrin.h>
+#endif
+
+LC_NAMESPACE_BEGIN
+
+// Thin wrappers for parking on a 32-bit atomic. On Linux they are futex
+// calls with absolute CLOCK_MONOTONIC deadlines (the clock behind
+// std::chrono::steady_clock); elsewhere untimed waits use std::atomic
+// wait/notify and timed waits poll. Waits may return spuriously, so
+// callers re-check their condition.
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(_M_X64)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Block while `word` holds `expected`.
+inline void futex_wait(std::atomic<uint32_t> &word, uint32_t expected) {
+#if defined(LC_PLATFORM_LINUX)
+    ::syscall(SYS_futex,
+              reinterpret_cast<uint32_t *>(&word),
+              FUTEX_WAIT_PRIVATE,
+              expected,
+              nullptr,
+              nullptr,
+              0);
+#else
+    word.wait(expected, std::memory_order_acquire);
+#endif
+}
+
+// Block while `word` holds `expected`, at most until `deadline`. Returns
+// false if the deadline passed.
+inline bool futex_wait_until(std::atomic<uint32_t>                &word,
+                             uint32_t                              expected,
+                             std::chrono::steady_clock::time_point deadline) {
+#if defined(LC_PLATFORM_LINUX)
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  deadline.time_since_epoch())
+                  .count();
+    if (ns <= 0) {
+        return false;
+    }
+    timespec ts {static_cast<time_t>(ns / 1000000000),
+                 static_cast<long>(ns % 1000000000)};
+    long     rc = ::syscall(SYS_futex,
+                        reinterpret_cast<uint32_t *>(&word),
+                        FUTEX_WAIT_BITSET_PRIVATE,
+                        expected,
+                        &ts,
+                        nullptr,
+                        FUTEX_BITSET_MATCH_ANY);
+    return rc == 0 || errno != ETIMEDOUT;
+#else
+    while (word.load(std::memory_order_acquire) == expected) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    return true;
+#endif
+}
+
+// Wake up to `count` threads blocked on `word`; INT_MAX wakes all.
+inline void futex_wake(std::atomic<uint32_t> &word, int count) {
+#if defined(LC_PLATFORM_LINUX)
+    ::syscall(SYS_futex,
+              reinterpret_cast<uint32_t *>(&word),
+              FUTEX_WAKE_PRIVATE,
+              count,
+              nullptr,
+              nullptr,
+              0);
+#else
+    if (count == 1) {
+        word.notify_one();
+    } else {
+        word.notify_all();
+    }
+#endif
+}
+
+LC_NAMESPACE_END
+
+#endif  // LC_FUTEX_H
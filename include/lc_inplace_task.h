@@ -0,0 +1,113 @@
+#ifndef LC_INPLACE_TASK_H
+#define LC_INPLACE_TASK_H
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+// Move-only `void()` callable kept in a fixed buffer inside the object, so
+// it never allocates. A callable that does not fit is a compile error
+// rather than a silent fallback to the heap.
+template <std::size_t Capacity>
+class InplaceTask {
+    struct Ops {
+        void (*invoke)(void *);
+        void (*relocate)(void *to, void *from);
+        void (*destroy)(void *);
+    };
+
+    template <typename Func>
+    static constexpr Ops kOps = {
+        [](void *self) { std::invoke(*static_cast<Func *>(self)); },
+        [](void *to, void *from) {
+            auto *source = static_cast<Func *>(from);
+            ::new (to) Func(std::move(*source));
+            std::destroy_at(source);
+        },
+        [](void *self) { std::destroy_at(static_cast<Func *>(self)); },
+    };
+
+public:
+    static constexpr std::size_t kCapacity = Capacity;
+
+    InplaceTask() = default;
+
+    InplaceTask(std::nullptr_t) {}
+
+    template <typename Func>
+        requires(!std::same_as<std::decay_t<Func>, InplaceTask>) &&
+                std::invocable<std::decay_t<Func> &>
+    InplaceTask(Func &&func) {
+        using Stored = std::decay_t<Func>;
+        static_assert(sizeof(Stored) <= Capacity,
+                      "Callable does not fit the task storage.");
+        static_assert(alignof(Stored) <= alignof(std::max_align_t),
+                      "Callable is over-aligned for the task storage.");
+        static_assert(std::is_nothrow_move_constructible_v<Stored>,
+                      "Callable must be nothrow move constructible.");
+        ::new (storage_) Stored(std::forward<Func>(func));
+        ops_ = &kOps<Stored>;
+    }
+
+    InplaceTask(InplaceTask &&other) noexcept : ops_(other.ops_) {
+        if (ops_ != nullptr) {
+            ops_->relocate(storage_, other.storage_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    InplaceTask &operator=(InplaceTask &&other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.ops_ != nullptr) {
+                other.ops_->relocate(storage_, other.storage_);
+                ops_ = std::exchange(other.ops_, nullptr);
+            }
+        }
+        return *this;
+    }
+
+    InplaceTask &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    InplaceTask(const InplaceTask &)            = delete;
+    InplaceTask &operator=(const InplaceTask &) = delete;
+
+    ~InplaceTask() {
+        reset();
+    }
+
+    void operator()() {
+        ops_->invoke(storage_);
+    }
+
+    explicit operator bool() const noexcept {
+        return ops_ != nullptr;
+    }
+
+private:
+
+    void reset() noexcept {
+        if (ops_ != nullptr) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[Capacity];
+    const Ops *ops_ = nullptr;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_INPLACE_TASK_H
@@ -1,12 +1,17 @@
 #ifndef LC_MPMC_QUEUE_H
 #define LC_MPMC_QUEUE_H
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <new>
+#include <optional>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
 
 #include "lc_config.h"
 
@@ -16,14 +21,27 @@ template <typename Tp_>
     requires std::is_move_constructible_v<Tp_> ||
              std::is_copy_constructible_v<Tp_>
 class MPMCQueue {
+    // Elements live in raw storage and are only constructed while queued,
+    // so Tp_ need not be default-constructible. `filled` is false for a
+    // cell whose construction threw; consumers skip it.
     struct alignas(64) Cell {
         std::atomic<std::size_t> sequence;
-        Tp_                      value;
+        bool                     filled;
+        alignas(Tp_) unsigned char storage[sizeof(Tp_)];
+
+        Tp_ *value() {
+            return std::launder(reinterpret_cast<Tp_ *>(storage));
+        }
     };
 
     static constexpr size_t __LC_CACHE_LINE_SIZE = 64;
     typedef char            __lc_cacheline_pad_t[__LC_CACHE_LINE_SIZE];
 
+    // Producers sample the occupancy for the high-water mark once every
+    // this many enqueues, so the consumers' index is rarely read on the
+    // enqueue path.
+    static constexpr size_t kHighWaterSamplePeriod = 64;
+
 public:
 
     explicit MPMCQueue(std::size_t queue_size) :
@@ -37,9 +55,14 @@ public:
         }
         enqueue_index_.store(0, std::memory_order_relaxed);
         dequeue_index_.store(0, std::memory_order_relaxed);
+        high_water_.store(0, std::memory_order_relaxed);
     }
 
-    ~MPMCQueue() = default;
+    ~MPMCQueue() {
+        if constexpr (!std::is_trivially_destructible_v<Tp_>) {
+            while (consume([](Tp_ &&) {})) {}
+        }
+    }
 
     MPMCQueue()                             = delete;
     MPMCQueue(const MPMCQueue &)            = delete;
@@ -47,8 +70,111 @@ public:
     MPMCQueue(MPMCQueue &&)                 = delete;
     MPMCQueue &operator=(MPMCQueue &&)      = delete;
 
-    [[nodiscard]] bool enqueue(Tp_ value) {
-        std::size_t pos = enqueue_index_.load(std::memory_order_relaxed);
+    // On failure `value` is left untouched, so the caller can retry with it.
+    [[nodiscard]] bool enqueue(Tp_ &&value) {
+        return emplace(std::move(value));
+    }
+
+    [[nodiscard]] bool enqueue(const Tp_ &value) {
+        return emplace(value);
+    }
+
+    // Construct an element in place from `args`. Nothing is constructed if
+    // the queue is full.
+    template <typename... Args>
+        requires std::constructible_from<Tp_, Args...>
+    [[nodiscard]] bool emplace(Args &&...args) {
+        std::size_t pos;
+        Cell       *cell = claim_enqueue(pos);
+        if (cell == nullptr) {
+            return false;
+        }
+        if constexpr (std::is_nothrow_constructible_v<Tp_, Args...>) {
+            std::construct_at(cell->value(), std::forward<Args>(args)...);
+        } else {
+            try {
+                std::construct_at(cell->value(), std::forward<Args>(args)...);
+            } catch (...) {
+                // The cell is claimed and must be handed on, empty.
+                publish(*cell, pos, false);
+                throw;
+            }
+        }
+        publish(*cell, pos, true);
+        return true;
+    }
+
+    [[nodiscard]] bool dequeue(Tp_ &value) {
+        return consume([&value](Tp_ &&item) { value = std::move(item); });
+    }
+
+    std::optional<Tp_> try_dequeue() {
+        std::optional<Tp_> result;
+        consume([&result](Tp_ &&item) { result.emplace(std::move(item)); });
+        return result;
+    }
+
+    // Pass the next element to `func` as an rvalue reference while it is
+    // still in its cell, then destroy it. The cell is released when `func`
+    // returns (or throws), so keep `func` short. Returns false if empty.
+    template <typename Func>
+        requires std::invocable<Func, Tp_ &&>
+    bool consume(Func &&func) {
+        std::size_t pos;
+        Cell       *cell = claim_dequeue(pos);
+        if (cell == nullptr) {
+            return false;
+        }
+        struct Release {
+            MPMCQueue *queue;
+            Cell      *cell;
+            size_t     pos;
+
+            ~Release() {
+                std::destroy_at(cell->value());
+                queue->release(*cell, pos);
+            }
+        } release {this, cell, pos};
+        std::invoke(std::forward<Func>(func), std::move(*cell->value()));
+        return true;
+    }
+
+    std::size_t capacity() const {
+        return pool_mask_ + 1;
+    }
+
+    // Number of queued elements. Only a snapshot while other threads are
+    // operating on the queue (enqueues count from the moment they claim a
+    // cell), and exact once the queue is quiescent. Reads both indices
+    // without writing, so polling it from a monitor does not invalidate
+    // the producers' and consumers' cache lines.
+    std::size_t size() const {
+        // Dequeues never overtake enqueues, so reading the dequeue index
+        // first keeps the difference from going negative.
+        std::size_t tail = dequeue_index_.load(std::memory_order_acquire);
+        std::size_t head = enqueue_index_.load(std::memory_order_acquire);
+        return std::min(head - tail, capacity());
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    // Highest occupancy seen since construction or the last reset. Sampled
+    // every kHighWaterSamplePeriod enqueues and whenever the queue was found
+    // full, so it can miss short peaks between samples.
+    std::size_t high_water_mark() const {
+        return high_water_.load(std::memory_order_relaxed);
+    }
+
+    void reset_high_water_mark() {
+        high_water_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+
+    Cell *claim_enqueue(std::size_t &pos) {
+        pos = enqueue_index_.load(std::memory_order_relaxed);
         while (true) {
             Cell         &cell = pool_[pos & pool_mask_];
             std::size_t   seq  = cell.sequence.load(std::memory_order_acquire);
@@ -58,22 +184,29 @@ public:
                         pos,
                         pos + 1,
                         std::memory_order_relaxed)) {
-                    cell.value = std::move(value);
-                    cell.sequence.store(pos + 1, std::memory_order_release);
-                    return true;  // Successfully enqueued
+                    return &cell;
                 }
             } else if (diff < 0) {
-                return false;     // Queue is full
+                record_high_water(pool_mask_ + 1);
+                return nullptr;  // Queue is full
             } else {
                 pos = enqueue_index_.load(std::memory_order_relaxed);
             }
         }
-        LC_ASSERT(false, "Should never reach here");
-        return false;  // Should never reach here
     }
 
-    [[nodiscard]] bool dequeue(Tp_ &value) {
-        std::size_t pos = dequeue_index_.load(std::memory_order_relaxed);
+    void publish(Cell &cell, std::size_t pos, bool filled) {
+        cell.filled = filled;
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        if ((pos & (kHighWaterSamplePeriod - 1)) == 0) {
+            sample_high_water(pos + 1);
+        }
+    }
+
+    // Claims the oldest filled cell, handing on any left empty by a
+    // throwing constructor.
+    Cell *claim_dequeue(std::size_t &pos) {
+        pos = dequeue_index_.load(std::memory_order_relaxed);
         while (true) {
             Cell         &cell = pool_[pos & pool_mask_];
             std::size_t   seq  = cell.sequence.load(std::memory_order_acquire);
@@ -83,27 +216,46 @@ public:
                         pos,
                         pos + 1,
                         std::memory_order_relaxed)) {
-                    value = std::move(cell.value);
-                    cell.sequence.store(pos + pool_mask_ + 1,
-                                        std::memory_order_release);
-                    return true;
+                    if (cell.filled) {
+                        return &cell;
+                    }
+                    release(cell, pos);
+                    pos = dequeue_index_.load(std::memory_order_relaxed);
                 }
             } else if (diff < 0) {
-                return false;  // Queue is empty
+                return nullptr;  // Queue is empty
             } else {
                 pos = dequeue_index_.load(std::memory_order_relaxed);
             }
         }
-        LC_ASSERT(false, "Should never reach here");
-        return false;  // Should never reach here
     }
 
-private:
+    void release(Cell &cell, std::size_t pos) {
+        cell.sequence.store(pos + pool_mask_ + 1, std::memory_order_release);
+    }
+
+    // Consumers may already be past `head` when the sample is taken.
+    void sample_high_water(std::size_t head) {
+        std::size_t tail = dequeue_index_.load(std::memory_order_relaxed);
+        if (head > tail) {
+            record_high_water(head - tail);
+        }
+    }
+
+    void record_high_water(std::size_t occupancy) {
+        std::size_t seen = high_water_.load(std::memory_order_relaxed);
+        while (occupancy > seen &&
+               !high_water_.compare_exchange_weak(seen,
+                                                  occupancy,
+                                                  std::memory_order_relaxed)) {
+        }
+    }
 
     std::unique_ptr<Cell[]> pool_;
     const std::size_t       pool_mask_;
     alignas(64) std::atomic<std::size_t> enqueue_index_;
     alignas(64) std::atomic<std::size_t> dequeue_index_;
+    alignas(64) std::atomic<std::size_t> high_water_;
 };
 
 LC_NAMESPACE_END
@@ -0,0 +1,309 @@
+#ifndef LC_MULTI_QUEUE_H
+#define LC_MULTI_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+// Priority of a queued value, larger first: `metadata.priority` for pool
+// tasks whose metadata has one, the value itself for integers, and 0
+// (plain FIFO) for anything else.
+template <typename Tp_>
+struct DefaultPriority {
+    int64_t operator()(const Tp_ &value) const {
+        if constexpr (requires {
+                          {
+                              value.metadata.priority
+                          } -> std::convertible_to<int64_t>;
+                      }) {
+            return static_cast<int64_t>(value.metadata.priority);
+        } else if constexpr (std::is_integral_v<Tp_>) {
+            return static_cast<int64_t>(value);
+        } else {
+            return 0;
+        }
+    }
+};
+
+// Relaxed concurrent priority queue after Rihani, Sanders and Dementiev
+// ("MultiQueues: Simple Relaxed Concurrent Priority Queues", SPAA 2015).
+// Values are spread over c·p small heaps, each behind its own spin lock.
+// A push locks any one heap; a pop looks at the tops of two random heaps
+// and takes from the better one. Threads rarely meet on a lock, and the
+// popped value is close to, but not always, the global best: the expected
+// rank error grows with the number of heaps, not with the load.
+//
+// Values of equal priority leave a heap in the order they entered it. With
+// one heap the queue is an exact (locked) priority queue.
+template <typename Tp_, typename PriorityFn = DefaultPriority<Tp_>>
+    requires std::is_move_constructible_v<Tp_> &&
+             std::is_invocable_r_v<int64_t, const PriorityFn &, const Tp_ &>
+class MultiQueue {
+    struct Entry {
+        int64_t  priority;
+        uint64_t sequence;
+        Tp_      value;
+    };
+
+    // Heap order: true when `a` should be popped after `b`.
+    static bool after(const Entry &a, const Entry &b) {
+        if (a.priority != b.priority) {
+            return a.priority < b.priority;
+        }
+        return a.sequence > b.sequence;
+    }
+
+    // `top` and `size` are written under the lock and read without it to
+    // pick a heap; `top` is meaningless while `size` is 0.
+    struct alignas(64) Heap {
+        std::atomic<bool>        locked {false};
+        std::atomic<int64_t>     top {0};
+        std::atomic<std::size_t> size {0};
+        uint64_t                 next_sequence = 0;
+        std::vector<Entry>       entries;
+
+        bool try_lock() {
+            return !locked.load(std::memory_order_relaxed) &&
+                   !locked.exchange(true, std::memory_order_acquire);
+        }
+
+        void lock() {
+            while (!try_lock()) {
+                std::this_thread::yield();
+            }
+        }
+
+        void unlock() {
+            locked.store(false, std::memory_order_release);
+        }
+    };
+
+    // Random heaps tried before falling back to a full scan.
+    static constexpr int kSampleAttempts = 4;
+
+public:
+
+    // Heaps per hardware thread when no heap count is given.
+    static constexpr std::size_t kHeapsPerThread = 2;
+
+    static std::size_t default_heap_count() {
+        return kHeapsPerThread *
+               std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // `queue_size` is split evenly over the heaps, rounded up.
+    explicit MultiQueue(std::size_t queue_size,
+                        std::size_t heap_count = default_heap_count(),
+                        PriorityFn  priority   = PriorityFn {}) :
+        heap_count_(heap_count),
+        heap_capacity_(heap_count == 0 ? 0
+                                       : (queue_size + heap_count - 1) /
+                                             heap_count),
+        priority_(std::move(priority)) {
+        if (queue_size == 0 || heap_count == 0) {
+            throw std::invalid_argument(
+                "Queue size and heap count must be positive.");
+        }
+        heaps_ = std::make_unique<Heap[]>(heap_count_);
+        for (std::size_t i = 0; i < heap_count_; ++i) {
+            heaps_[i].entries.reserve(heap_capacity_);
+        }
+    }
+
+    MultiQueue(const MultiQueue &)            = delete;
+    MultiQueue &operator=(const MultiQueue &) = delete;
+
+    // On failure `value` is left untouched, so the caller can retry with it.
+    [[nodiscard]] bool enqueue(Tp_ &&value) {
+        return push(std::move(value));
+    }
+
+    [[nodiscard]] bool enqueue(const Tp_ &value) {
+        return push(value);
+    }
+
+    // The value is built before a heap is chosen, since its priority picks
+    // its place; on failure `args` may have been moved from.
+    template <typename... Args>
+        requires std::constructible_from<Tp_, Args...>
+    [[nodiscard]] bool emplace(Args &&...args) {
+        return push(Tp_(std::forward<Args>(args)...));
+    }
+
+    [[nodiscard]] bool dequeue(Tp_ &value) {
+        return consume([&value](Tp_ &&item) { value = std::move(item); });
+    }
+
+    std::optional<Tp_> try_dequeue() {
+        return pop();
+    }
+
+    // Fails only when every heap is empty.
+    template <typename Func>
+        requires std::invocable<Func, Tp_ &&>
+    bool consume(Func &&func) {
+        std::optional<Tp_> value = pop();
+        if (!value) {
+            return false;
+        }
+        std::invoke(std::forward<Func>(func), std::move(*value));
+        return true;
+    }
+
+    std::size_t heap_count() const {
+        return heap_count_;
+    }
+
+    std::size_t capacity() const {
+        return heap_count_ * heap_capacity_;
+    }
+
+    std::size_t size() const {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < heap_count_; ++i) {
+            total += heaps_[i].size.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+private:
+
+    template <typename Value>
+    bool push(Value &&value) {
+        int64_t priority = std::invoke(priority_, std::as_const(value));
+        Heap   *heap     = lock_heap_with_room();
+        if (heap == nullptr) {
+            return false;  // Every heap is full
+        }
+        std::unique_lock<Heap> guard(*heap, std::adopt_lock);
+        heap->entries.push_back(Entry {
+            priority, heap->next_sequence++, std::forward<Value>(value)});
+        std::push_heap(heap->entries.begin(), heap->entries.end(), after);
+        publish(*heap);
+        return true;
+    }
+
+    std::optional<Tp_> pop() {
+        for (int attempt = 0; attempt < kSampleAttempts; ++attempt) {
+            Heap *heap = better(heaps_[random_index()], heaps_[random_index()]);
+            if (heap == nullptr || !heap->try_lock()) {
+                continue;
+            }
+            std::unique_lock<Heap> guard(*heap, std::adopt_lock);
+            if (std::optional<Tp_> value = pop_locked(*heap)) {
+                return value;
+            }
+        }
+        // Sampling kept missing: scan every heap, so a non-empty queue is
+        // never reported empty.
+        std::size_t start = random_index();
+        for (std::size_t i = 0; i < heap_count_; ++i) {
+            Heap &heap = heaps_[(start + i) % heap_count_];
+            if (heap.size.load(std::memory_order_acquire) == 0) {
+                continue;
+            }
+            std::unique_lock<Heap> guard(heap);
+            if (std::optional<Tp_> value = pop_locked(heap)) {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    Heap *lock_heap_with_room() {
+        for (int attempt = 0; attempt < kSampleAttempts; ++attempt) {
+            Heap &heap = heaps_[random_index()];
+            if (heap.try_lock()) {
+                if (heap.entries.size() < heap_capacity_) {
+                    return &heap;
+                }
+                heap.unlock();
+            }
+        }
+        std::size_t start = random_index();
+        for (std::size_t i = 0; i < heap_count_; ++i) {
+            Heap &heap = heaps_[(start + i) % heap_count_];
+            heap.lock();
+            if (heap.entries.size() < heap_capacity_) {
+                return &heap;
+            }
+            heap.unlock();
+        }
+        return nullptr;
+    }
+
+    // The heap with the higher top, or nullptr if both look empty.
+    static Heap *better(Heap &a, Heap &b) {
+        bool a_empty = a.size.load(std::memory_order_acquire) == 0;
+        bool b_empty = b.size.load(std::memory_order_acquire) == 0;
+        if (a_empty || b_empty) {
+            return a_empty ? (b_empty ? nullptr : &b) : &a;
+        }
+        return a.top.load(std::memory_order_relaxed) >=
+                       b.top.load(std::memory_order_relaxed)
+                   ? &a
+                   : &b;
+    }
+
+    static std::optional<Tp_> pop_locked(Heap &heap) {
+        if (heap.entries.empty()) {
+            return std::nullopt;
+        }
+        std::pop_heap(heap.entries.begin(), heap.entries.end(), after);
+        std::optional<Tp_> value(std::move(heap.entries.back().value));
+        heap.entries.pop_back();
+        publish(heap);
+        return value;
+    }
+
+    static void publish(Heap &heap) {
+        if (!heap.entries.empty()) {
+            heap.top.store(heap.entries.front().priority,
+                           std::memory_order_relaxed);
+        }
+        heap.size.store(heap.entries.size(), std::memory_order_release);
+    }
+
+    // xorshift64, one stream per thread; only spreads load.
+    std::size_t random_index() const {
+        if (rng_state_ == 0) {
+            rng_state_ = std::hash<std::thread::id> {}(
+                             std::this_thread::get_id()) |
+                         1;
+        }
+        rng_state_ ^= rng_state_ << 13;
+        rng_state_ ^= rng_state_ >> 7;
+        rng_state_ ^= rng_state_ << 17;
+        return static_cast<std::size_t>(rng_state_ % heap_count_);
+    }
+
+    std::size_t             heap_count_;
+    std::size_t             heap_capacity_;
+    PriorityFn              priority_;
+    std::unique_ptr<Heap[]> heaps_;
+
+    static inline LC_THREAD_LOCAL uint64_t rng_state_ = 0;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_MULTI_QUEUE_H
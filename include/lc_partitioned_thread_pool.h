@@ -0,0 +1,261 @@
+#ifndef LC_PARTITIONED_THREAD_POOL_H
+#define LC_PARTITIONED_THREAD_POOL_H
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "lc_config.h"
+#include "lc_context.h"
+#include "lc_mpmc_queue.h"
+#include "lc_wait_strategy.h"
+
+LC_NAMESPACE_BEGIN
+
+struct PartitionOptions {
+    std::size_t queue_size  = 1024;  // power of two
+    std::size_t weight      = 1;     // DRR quantum, in tasks per round
+    std::size_t min_workers = 0;     // served ahead of DRR below this
+    std::size_t max_workers = 0;     // concurrency cap, 0 for no cap
+};
+
+// One set of workers serving several logical sub-pools ("partitions"), each
+// with its own queue. Workers pick partitions by deficit round robin, so a
+// partition with weight w gets w tasks per round while it has work. A
+// partition running fewer than `min_workers` tasks is served before the
+// round robin, and one running `max_workers` tasks is skipped, which keeps
+// a saturated partition from starving the others without dedicating
+// threads to each of them.
+//
+// Every worker keeps its own deficit counters and cursor; the only shared
+// scheduling state is each partition's running-task counter.
+template <size_t PoolSize, typename Meta = EmptyMetadata,
+          typename WaitStrategy = AtomicWaitStrategy>
+    requires std::derived_from<WaitStrategy, WaitStrategyBase>
+class PartitionedThreadPool {
+    using InternalTask = Context<Meta, std::function<void()>>;
+
+    struct alignas(64) Partition {
+        explicit Partition(const PartitionOptions &options) :
+            queue(options.queue_size),
+            weight(options.weight),
+            min_workers(options.min_workers),
+            max_workers(options.max_workers == 0 ? PoolSize
+                                                 : options.max_workers) {}
+
+        MPMCQueue<InternalTask>          queue;
+        const std::size_t                weight;
+        const std::size_t                min_workers;
+        const std::size_t                max_workers;
+        alignas(64) std::atomic<size_t> running {0};
+    };
+
+    enum class Pick {
+        Ran,
+        Empty,
+        Capped
+    };
+
+public:
+
+    explicit PartitionedThreadPool(
+        const std::vector<PartitionOptions> &partitions) {
+        if (partitions.empty()) {
+            throw std::invalid_argument(
+                "At least one partition is required.");
+        }
+        for (const auto &options : partitions) {
+            if (options.weight == 0) {
+                throw std::invalid_argument(
+                    "Partition weight must be positive.");
+            }
+            partitions_.push_back(std::make_unique<Partition>(options));
+        }
+        state_.store(State::Initializing, std::memory_order_relaxed);
+        wait_strategy_ = std::make_shared<WaitStrategy>();
+        for (size_t i = 0; i < PoolSize; ++i) {
+            workers_[i] =
+                std::thread(&PartitionedThreadPool::worker_thread, this, i);
+        }
+        state_.store(State::Running, std::memory_order_release);
+    }
+
+    PartitionedThreadPool(std::initializer_list<PartitionOptions> partitions) :
+        PartitionedThreadPool(std::vector<PartitionOptions>(partitions)) {}
+
+    ~PartitionedThreadPool() {
+        shutdown();
+    }
+
+    PartitionedThreadPool(const PartitionedThreadPool &)            = delete;
+    PartitionedThreadPool &operator=(const PartitionedThreadPool &) = delete;
+
+    template <typename Func, typename... Args>
+        requires std::invocable<Func, Args...>
+    auto submit(size_t partition, Func &&func, Args &&...args)
+        -> std::future<std::invoke_result_t<Func, Args...>> {
+        return submit(partition,
+                      Meta {},
+                      std::forward<Func>(func),
+                      std::forward<Args>(args)...);
+    }
+
+    template <typename Ctx, typename Func, typename... Args>
+        requires std::invocable<Func, Args...> &&
+                 std::constructible_from<Meta, Ctx>
+    auto submit(size_t partition, Ctx &&ctx, Func &&func, Args &&...args)
+        -> std::future<std::invoke_result_t<Func, Args...>> {
+        if (partition >= partitions_.size()) {
+            throw std::out_of_range("Partition index out of range");
+        }
+        using ResultType = std::invoke_result_t<Func, Args...>;
+        auto bound_func =
+            std::bind(std::forward<Func>(func), std::forward<Args>(args)...);
+        auto task_ptr = std::make_shared<std::packaged_task<ResultType()>>(
+            std::move(bound_func));
+        auto         future = task_ptr->get_future();
+        InternalTask task {Meta(std::forward<Ctx>(ctx)),
+                           [task_ptr]() mutable { (*task_ptr)(); }};
+        if (!partitions_[partition]->queue.enqueue(std::move(task))) {
+            throw std::runtime_error("Failed to enqueue task");
+        }
+        wait_strategy_->notify();
+        return future;
+    }
+
+    size_t partition_count() const {
+        return partitions_.size();
+    }
+
+    // Number of tasks of `partition` currently executing.
+    size_t running(size_t partition) const {
+        return partitions_.at(partition)->running.load(
+            std::memory_order_relaxed);
+    }
+
+    void shutdown() {
+        if (state_.load(std::memory_order_relaxed) != State::Running) {
+            return;  // Already shutting down or stopped
+        }
+        state_.store(State::Stopping, std::memory_order_release);
+        wait_strategy_->notify_all();
+        for (auto &worker : workers_) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+        state_.store(State::Stopped, std::memory_order_release);
+    }
+
+private:
+
+    struct Scheduler {
+        std::vector<int64_t> deficit;
+        size_t               cursor;
+    };
+
+    void worker_thread(size_t index) {
+        auto     &strategy = *wait_strategy_;
+        Scheduler scheduler {std::vector<int64_t>(partitions_.size(), 0),
+                             index % partitions_.size()};
+        scheduler.deficit[scheduler.cursor] =
+            static_cast<int64_t>(partitions_[scheduler.cursor]->weight);
+        while (true) {
+            if (run_next(scheduler)) {
+                strategy.reset();
+                continue;
+            }
+            if (state_.load(std::memory_order_relaxed) == State::Stopping) {
+                strategy.notify_all();  // Re-wake siblings a reset() put back
+                                        // to sleep after shutdown's notify
+                break;
+            }
+            strategy.wait();
+        }
+    }
+
+    bool run_next(Scheduler &scheduler) {
+        const size_t count = partitions_.size();
+
+        // Guaranteed shares first.
+        for (size_t i = 0; i < count; ++i) {
+            auto &partition = *partitions_[(scheduler.cursor + i) % count];
+            if (partition.running.load(std::memory_order_relaxed) <
+                    partition.min_workers &&
+                try_run(partition) == Pick::Ran) {
+                return true;
+            }
+        }
+
+        // Deficit round robin; one extra step lets the starting partition
+        // be revisited after its deficit was refilled.
+        for (size_t step = 0; step <= count; ++step) {
+            size_t current = scheduler.cursor;
+            if (scheduler.deficit[current] > 0) {
+                Pick pick = try_run(*partitions_[current]);
+                if (pick == Pick::Ran) {
+                    --scheduler.deficit[current];
+                    return true;
+                }
+                if (pick == Pick::Empty) {
+                    scheduler.deficit[current] = 0;
+                }
+            }
+            // Unit-cost tasks leave no remainder worth carrying over.
+            scheduler.cursor = (current + 1) % count;
+            scheduler.deficit[scheduler.cursor] =
+                static_cast<int64_t>(partitions_[scheduler.cursor]->weight);
+        }
+        return false;
+    }
+
+    Pick try_run(Partition &partition) {
+        // A CAS rather than fetch_add: a transient over-count could make two
+        // workers both see the partition as capped and park with work left.
+        size_t running = partition.running.load(std::memory_order_acquire);
+        do {
+            if (running >= partition.max_workers) {
+                return Pick::Capped;
+            }
+        } while (!partition.running.compare_exchange_weak(
+            running,
+            running + 1,
+            std::memory_order_acq_rel));
+        std::optional<InternalTask> task = partition.queue.try_dequeue();
+        if (!task) {
+            partition.running.fetch_sub(1, std::memory_order_acq_rel);
+            return Pick::Empty;
+        }
+        task->data();
+        partition.running.fetch_sub(1, std::memory_order_acq_rel);
+        return Pick::Ran;
+    }
+
+    enum class State {
+        Initializing,
+        Running,
+        Stopping,
+        Stopped
+    };
+
+    std::vector<std::unique_ptr<Partition>> partitions_;
+    std::array<std::thread, PoolSize>       workers_;
+    std::atomic<State>                      state_;
+    std::shared_ptr<WaitStrategy>           wait_strategy_;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_PARTITIONED_THREAD_POOL_H
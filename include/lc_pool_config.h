@@ -0,0 +1,143 @@
+#ifndef LC_POOL_CONFIG_H
+#define LC_POOL_CONFIG_H
+
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#include "lc_bump_arena.h"
+#include "lc_config.h"
+#include "lc_inplace_task.h"
+#include "lc_mpmc_queue.h"
+#include "lc_wait_strategy.h"
+
+#if defined(LC_PLATFORM_LINUX)
+#  include <sched.h>
+#endif
+
+LC_NAMESPACE_BEGIN
+
+// Leaves worker placement to the scheduler.
+struct NoAffinity {
+    static void on_worker_start(std::size_t) {}
+};
+
+// Pins worker i to the i-th CPU the process may run on, wrapping around
+// when there are more workers than CPUs. Linux only; elsewhere a no-op.
+struct PinnedAffinity {
+    static void on_worker_start(std::size_t index) {
+#if defined(LC_PLATFORM_LINUX)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+            return;
+        }
+        int count = CPU_COUNT(&allowed);
+        if (count == 0) {
+            return;
+        }
+        int target = static_cast<int>(index % count);
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+                cpu_set_t pinned;
+                CPU_ZERO(&pinned);
+                CPU_SET(cpu, &pinned);
+                sched_setaffinity(0, sizeof(pinned), &pinned);
+                return;
+            }
+        }
+#else
+        (void)index;
+#endif
+    }
+};
+
+// Compile-time policies of a BasicThreadPool. Derive from this and
+// override what differs:
+//
+//   struct LowLatency : DefaultPoolConfig {
+//       using WaitStrategy = SpinBackOffWaitStrategy<>;
+//       static constexpr std::size_t kTaskStorageSize = 32;
+//   };
+//
+// Features that are off add no members and no work to the task path.
+struct DefaultPoolConfig {
+    // Task queue template; see TaskQueueOf.
+    template <typename Tp_>
+    using Queue        = MPMCQueue<Tp_>;
+    using WaitStrategy = AtomicWaitStrategy;
+    // Called on each worker thread before it takes tasks.
+    using Affinity     = NoAffinity;
+
+    // Bytes of inline storage per task callable. 0 keeps std::function;
+    // otherwise tasks are InplaceTask<kTaskStorageSize> and never allocate
+    // for the callable. The pool's own wrappers need 16 bytes.
+    static constexpr std::size_t kTaskStorageSize = 0;
+
+    // Idle workers that spin on the queues instead of parking, so a new
+    // task is picked up at spin latency. The rest park on a futex and are
+    // woken when no hot worker is free or outstanding tasks outnumber
+    // awake workers; a hot worker that finds nothing for kHotIdleTimeout
+    // parks as well. Non-zero replaces WaitStrategy for the fixed workers;
+    // 0 idles every worker through WaitStrategy.
+    static constexpr std::size_t               kHotWorkers     = 0;
+    static constexpr std::chrono::microseconds kHotIdleTimeout {200};
+
+    // Capacity of each worker's own queue, a power of two. Non-zero enables
+    // BasicThreadPool::submit_to() and, for AffinityMetadata, routing each
+    // task to the worker its affinity_key hashes to. Idle workers steal
+    // only from busy workers' queues. Each fixed worker then parks on a
+    // futex of its own instead of WaitStrategy, so a task routed to an
+    // idle worker wakes that worker. 0 leaves the queues out.
+    static constexpr std::size_t kWorkerQueueSize = 0;
+
+    // Size of each block of a worker's scratch arena; see
+    // BasicThreadPool::arena(). Nothing is allocated until a task uses it.
+    static constexpr std::size_t kArenaBlockSize =
+        BumpArena::kDefaultBlockSize;
+
+    // Count submitted, rejected and completed tasks and their run time;
+    // read with BasicThreadPool::metrics().
+    static constexpr bool kMetrics = false;
+
+    // Report task lifecycle events to a callback set with
+    // BasicThreadPool::set_trace_callback().
+    static constexpr bool kTracing = false;
+};
+
+// The configuration behind the classic ThreadPool<N, Meta, WaitStrategy,
+// Queue> spelling.
+template <typename WaitStrategy_, template <typename> class Queue_>
+struct PoolConfig : DefaultPoolConfig {
+    template <typename Tp_>
+    using Queue        = Queue_<Tp_>;
+    using WaitStrategy = WaitStrategy_;
+};
+
+// Callable type stored in each task for a given storage size.
+template <std::size_t StorageSize>
+using TaskFunction = std::conditional_t<StorageSize == 0,
+                                        std::function<void()>,
+                                        InplaceTask<StorageSize>>;
+
+template <typename Config>
+concept ThreadPoolConfig = requires {
+    typename Config::template Queue<int>;
+    typename Config::WaitStrategy;
+    { Config::Affinity::on_worker_start(std::size_t {}) };
+    { Config::kTaskStorageSize } -> std::convertible_to<std::size_t>;
+    { Config::kHotWorkers } -> std::convertible_to<std::size_t>;
+    {
+        Config::kHotIdleTimeout
+    } -> std::convertible_to<std::chrono::nanoseconds>;
+    { Config::kWorkerQueueSize } -> std::convertible_to<std::size_t>;
+    { Config::kArenaBlockSize } -> std::convertible_to<std::size_t>;
+    { Config::kMetrics } -> std::convertible_to<bool>;
+    { Config::kTracing } -> std::convertible_to<bool>;
+} && std::derived_from<typename Config::WaitStrategy, WaitStrategyBase>;
+
+LC_NAMESPACE_END
+
+#endif  // LC_POOL_CONFIG_H
@@ -0,0 +1,75 @@
+#ifndef LC_RATE_LIMITER_H
+#define LC_RATE_LIMITER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+// Lock-free token bucket in its GCRA form: instead of a token count the
+// bucket keeps the theoretical arrival time (TAT) of the next token, so
+// reserving a token is a single CAS on one word. A reservation never
+// fails; it returns how long the caller has to wait for its token, which
+// lets the caller defer the work rather than sleep.
+class TokenBucket {
+public:
+
+    TokenBucket(double tokens_per_second, std::size_t burst) {
+        if (!(tokens_per_second > 0.0) || burst == 0) {
+            throw std::invalid_argument("Rate and burst must be positive.");
+        }
+        interval_ns_  = std::max<int64_t>(
+            1,
+            static_cast<int64_t>(1e9 / tokens_per_second));
+        tolerance_ns_ = interval_ns_ * static_cast<int64_t>(burst - 1);
+        tat_ns_.store(0, std::memory_order_relaxed);
+    }
+
+    TokenBucket(const TokenBucket &)            = delete;
+    TokenBucket &operator=(const TokenBucket &) = delete;
+
+    // Reserve one token at `now_ns` (steady clock). Returns the delay until
+    // the token becomes available; zero means it is available now.
+    std::chrono::nanoseconds acquire(int64_t now_ns) {
+        int64_t tat = tat_ns_.load(std::memory_order_relaxed);
+        while (!tat_ns_.compare_exchange_weak(tat,
+                                              std::max(tat, now_ns) +
+                                                  interval_ns_,
+                                              std::memory_order_relaxed)) {}
+        return std::chrono::nanoseconds(
+            std::max<int64_t>(0, tat - tolerance_ns_ - now_ns));
+    }
+
+    // Take a token only if one is available right now.
+    bool try_acquire(int64_t now_ns) {
+        int64_t tat = tat_ns_.load(std::memory_order_relaxed);
+        do {
+            if (tat - tolerance_ns_ > now_ns) {
+                return false;
+            }
+        } while (!tat_ns_.compare_exchange_weak(tat,
+                                                std::max(tat, now_ns) +
+                                                    interval_ns_,
+                                                std::memory_order_relaxed));
+        return true;
+    }
+
+    std::chrono::nanoseconds interval() const {
+        return std::chrono::nanoseconds(interval_ns_);
+    }
+
+private:
+    int64_t                          interval_ns_;
+    int64_t                          tolerance_ns_;
+    alignas(64) std::atomic<int64_t> tat_ns_;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_RATE_LIMITER_H
@@ -0,0 +1,354 @@
+#ifndef LC_REACTOR_H
+#define LC_REACTOR_H
+
+#include "lc_config.h"
+
+#if defined(LC_PLATFORM_LINUX)
+
+#  include <sys/epoll.h>
+#  include <sys/eventfd.h>
+#  include <unistd.h>
+
+#  include <atomic>
+#  include <cerrno>
+#  include <climits>
+#  include <cstddef>
+#  include <cstdint>
+#  include <functional>
+#  include <memory>
+#  include <mutex>
+#  include <stdexcept>
+#  include <system_error>
+#  include <unordered_map>
+#  include <utility>
+
+#  include "lc_wait_strategy.h"
+
+LC_NAMESPACE_BEGIN
+
+// Leader/follower reactor over an epoll set.
+//
+// Any number of threads may call poll(); exactly one of them (the leader)
+// sits in epoll_wait while the others park as followers. As soon as the
+// leader has events it hands leadership to a follower and runs the handlers
+// itself, so readiness is dispatched on the polling thread without a hop
+// through a separate event loop.
+//
+// File descriptors are registered with EPOLLONESHOT and re-armed after their
+// handler returns, which guarantees a handler never runs concurrently with
+// itself. wakeup() interrupts the leader through an internal eventfd; it
+// only writes while a leader is actually polling, and at most once until
+// that leader drains it. With no leader it leaves a pending flag that the
+// next leader checks before entering epoll_wait.
+class Reactor {
+    struct Registration {
+        int                           fd;
+        uint32_t                      events;
+        std::function<void(uint32_t)> handler;
+    };
+
+public:
+
+    using Handler = std::function<void(uint32_t)>;
+
+    static constexpr int kMaxEvents = 16;
+
+    Reactor() {
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) {
+            throw std::system_error(errno,
+                                    std::generic_category(),
+                                    "epoll_create1 failed");
+        }
+        wake_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (wake_fd_ < 0) {
+            int err = errno;
+            ::close(epoll_fd_);
+            throw std::system_error(err,
+                                    std::generic_category(),
+                                    "eventfd failed");
+        }
+        epoll_event ev {};
+        ev.events  = EPOLLIN;
+        ev.data.fd = wake_fd_;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) < 0) {
+            int err = errno;
+            ::close(wake_fd_);
+            ::close(epoll_fd_);
+            throw std::system_error(err,
+                                    std::generic_category(),
+                                    "epoll_ctl failed");
+        }
+        leader_.store(false, std::memory_order_relaxed);
+        pending_.store(false, std::memory_order_relaxed);
+        signaled_.store(false, std::memory_order_relaxed);
+        stopped_.store(false, std::memory_order_relaxed);
+        turn_.store(0, std::memory_order_relaxed);
+    }
+
+    ~Reactor() {
+        ::close(wake_fd_);
+        ::close(epoll_fd_);
+    }
+
+    Reactor(const Reactor &)            = delete;
+    Reactor &operator=(const Reactor &) = delete;
+    Reactor(Reactor &&)                 = delete;
+    Reactor &operator=(Reactor &&)      = delete;
+
+    // Register `fd` for `events`; `handler` receives the ready event mask.
+    // It runs on whichever thread is polling, so an exception it throws is
+    // caught and discarded there and the descriptor is re-armed as usual;
+    // handle errors inside the handler.
+    void add(int fd, uint32_t events, Handler handler) {
+        auto reg = std::make_shared<Registration>(
+            Registration {fd, events, std::move(handler)});
+        std::scoped_lock<std::mutex> lock(mtx_);
+        if (registrations_.contains(fd)) {
+            throw std::invalid_argument("File descriptor already registered.");
+        }
+        control(EPOLL_CTL_ADD, fd, events);
+        registrations_.emplace(fd, std::move(reg));
+    }
+
+    // Change the interest set of a registered descriptor. This also re-arms
+    // it, so call it from the descriptor's own handler or while it is idle.
+    void modify(int fd, uint32_t events) {
+        std::scoped_lock<std::mutex> lock(mtx_);
+        auto                         it = registrations_.find(fd);
+        if (it == registrations_.end()) {
+            throw std::invalid_argument("File descriptor not registered.");
+        }
+        it->second->events = events;
+        control(EPOLL_CTL_MOD, fd, events);
+    }
+
+    // Stop watching `fd`. A handler already running for it may finish, but
+    // it will not be re-armed.
+    void remove(int fd) {
+        std::scoped_lock<std::mutex> lock(mtx_);
+        if (registrations_.erase(fd) != 0) {
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        }
+    }
+
+    // Take a turn at polling. Followers park until the current leader hands
+    // off; the leader waits up to `timeout_ms` for readiness and dispatches
+    // the handlers. Returns true if the call consumed events or a wakeup.
+    bool poll(int timeout_ms = -1) {
+        if (stopped_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        uint32_t turn     = turn_.load(std::memory_order_acquire);
+        bool     expected = false;
+        if (!leader_.compare_exchange_strong(expected,
+                                             true,
+                                             std::memory_order_seq_cst)) {
+            turn_.wait(turn, std::memory_order_acquire);
+            return false;
+        }
+        // Pairs with wakeup(): either it sees us as leader and signals the
+        // eventfd, or we see its pending flag here and skip the wait.
+        if (pending_.exchange(false, std::memory_order_seq_cst)) {
+            hand_off();
+            return true;
+        }
+
+        epoll_event events[kMaxEvents];
+        int count = ::epoll_wait(epoll_fd_, events, kMaxEvents, timeout_ms);
+        int err   = errno;
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.fd == wake_fd_) {
+                drain_wakeup();
+            }
+        }
+        hand_off();
+
+        if (count < 0) {
+            if (err == EINTR) {
+                return false;
+            }
+            throw std::system_error(err,
+                                    std::generic_category(),
+                                    "epoll_wait failed");
+        }
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.fd != wake_fd_) {
+                dispatch(events[i].data.fd, events[i].events);
+            }
+        }
+        return count > 0;
+    }
+
+    // Interrupt one poll() call, current or future. Costs no syscall
+    // unless a leader is blocked in epoll_wait.
+    void wakeup() {
+        pending_.store(true, std::memory_order_seq_cst);
+        if (leader_.load(std::memory_order_seq_cst)) {
+            signal();
+        }
+    }
+
+    // Make every poll() call in progress return once, leaders and followers
+    // alike, without stopping the reactor.
+    void wake_all() {
+        pending_.store(true, std::memory_order_seq_cst);
+        signal();
+        turn_.fetch_add(1, std::memory_order_release);
+        turn_.notify_all();
+    }
+
+    // Make every current and future poll() return immediately. Meant for
+    // the reactor's owner; a shared reactor stays down for every user.
+    void stop() {
+        stopped_.store(true, std::memory_order_release);
+        wake_all();
+    }
+
+    bool stopped() const {
+        return stopped_.load(std::memory_order_acquire);
+    }
+
+    int native_handle() const {
+        return epoll_fd_;
+    }
+
+private:
+
+    void control(int op, int fd, uint32_t events) {
+        epoll_event ev {};
+        ev.events  = events | EPOLLONESHOT;
+        ev.data.fd = fd;
+        if (::epoll_ctl(epoll_fd_, op, fd, &ev) < 0) {
+            throw std::system_error(errno,
+                                    std::generic_category(),
+                                    "epoll_ctl failed");
+        }
+    }
+
+    void signal() {
+        if (!signaled_.exchange(true, std::memory_order_seq_cst)) {
+            uint64_t                value = 1;
+            LC_MAYBE_UNUSED ssize_t n =
+                ::write(wake_fd_, &value, sizeof(value));
+        }
+    }
+
+    // Runs while still leader, so a wakeup() that skipped its write because
+    // signaled_ was set is absorbed by this very poll() returning. Reading
+    // before disarming means the flag never claims a token that is gone.
+    void drain_wakeup() {
+        uint64_t                value;
+        LC_MAYBE_UNUSED ssize_t n = ::read(wake_fd_, &value, sizeof(value));
+        pending_.store(false, std::memory_order_relaxed);
+        signaled_.store(false, std::memory_order_seq_cst);
+    }
+
+    void hand_off() {
+        leader_.store(false, std::memory_order_release);
+        turn_.fetch_add(1, std::memory_order_release);
+        turn_.notify_one();
+    }
+
+    void dispatch(int fd, uint32_t events) {
+        std::shared_ptr<Registration> reg;
+        {
+            std::scoped_lock<std::mutex> lock(mtx_);
+            auto                         it = registrations_.find(fd);
+            if (it == registrations_.end()) {
+                return;
+            }
+            reg = it->second;
+        }
+        try {
+            reg->handler(events);
+        } catch (...) {
+            // The poller is usually a pool worker with nowhere to report
+            // to; keep the descriptor and the worker alive.
+        }
+
+        std::scoped_lock<std::mutex> lock(mtx_);
+        auto                         it = registrations_.find(fd);
+        if (it != registrations_.end() && it->second == reg) {
+            epoll_event ev {};
+            ev.events  = reg->events | EPOLLONESHOT;
+            ev.data.fd = fd;
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+        }
+    }
+
+    int        epoll_fd_;
+    int        wake_fd_;
+    std::mutex mtx_;
+    std::unordered_map<int, std::shared_ptr<Registration>> registrations_;
+    alignas(64) std::atomic<bool> leader_;
+    std::atomic<bool>             pending_;
+    std::atomic<bool>             signaled_;
+    std::atomic<bool>             stopped_;
+    alignas(64) std::atomic<uint32_t> turn_;
+};
+
+// Wait strategy that lets idle pool workers take turns as the reactor's
+// leader. Submitting a task wakes the current leader through the eventfd,
+// which hands off and goes back to the task queue. Shutting the pool down
+// only wakes the workers; the reactor itself keeps running, since it may be
+// shared with other pools through the second constructor. If its owner
+// stops the reactor while the pool still runs, idle workers park on a futex
+// instead of spinning through a poll() that returns at once.
+class ReactorWaitStrategy : public WaitStrategyBase {
+public:
+    ReactorWaitStrategy() : reactor_(std::make_shared<Reactor>()) {}
+
+    explicit ReactorWaitStrategy(std::shared_ptr<Reactor> reactor) :
+        reactor_(std::move(reactor)) {}
+
+    void wait() override {
+        if (!reactor_->stopped()) {
+            reactor_->poll();
+            return;
+        }
+        uint32_t epoch = epoch_.load(std::memory_order_acquire);
+        parked_.fetch_add(1, std::memory_order_seq_cst);
+        // Pairs with notify(): either we see its pending flag here or it
+        // sees us parked and bumps the epoch we wait on.
+        if (!pending_.exchange(false, std::memory_order_seq_cst)) {
+            futex_wait(epoch_, epoch);
+        }
+        parked_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notify() override {
+        reactor_->wakeup();
+        pending_.store(true, std::memory_order_seq_cst);
+        if (parked_.load(std::memory_order_seq_cst) != 0) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            futex_wake(epoch_, 1);
+        }
+    }
+
+    void notify_all() override {
+        reactor_->wake_all();
+        pending_.store(true, std::memory_order_seq_cst);
+        epoch_.fetch_add(1, std::memory_order_release);
+        futex_wake(epoch_, INT_MAX);
+    }
+
+    void reset() override {}
+
+    Reactor &reactor() {
+        return *reactor_;
+    }
+
+private:
+    std::shared_ptr<Reactor> reactor_;
+    // Fallback parking once the reactor is stopped.
+    alignas(64) std::atomic<uint32_t> epoch_ {0};
+    std::atomic<uint32_t>             parked_ {0};
+    std::atomic<bool>                 pending_ {false};
+};
+
+LC_NAMESPACE_END
+
+#endif  // defined(LC_PLATFORM_LINUX)
+
+#endif  // LC_REACTOR_H
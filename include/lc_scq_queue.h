@@ -0,0 +1,317 @@
+#ifndef LC_SCQ_QUEUE_H
+#define LC_SCQ_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+// Ring of small integers after Nikolaev's SCQ ("A Scalable, Portable, and
+// Memory-Efficient Lock-Free FIFO Queue", DISC 2019). Producers and
+// consumers take positions with fetch_add, which always succeeds, instead
+// of a compare-and-swap on the index that has to be retried under
+// contention. The ring has 2n entries for at most n values, so a producer
+// always finds a usable entry within a few positions.
+//
+// Each 64-bit entry holds the cycle (position / 2n) it was last written
+// in, an "unsafe" bit and the value. A consumer that overtakes a slow
+// producer bumps the entry's cycle so the producer moves on; one that
+// finds an unconsumed entry of an older cycle marks it unsafe so no
+// producer reuses it until the consumers have passed. `threshold_` bounds
+// how far consumers keep scanning an empty ring.
+class SCQRing {
+    static constexpr unsigned kRemapBits = 3;  // 8 entries per cache line
+
+public:
+
+    // Holds values in [0, capacity). Capacity must be a power of two.
+    explicit SCQRing(std::size_t capacity) :
+        capacity_(capacity),
+        order_(std::countr_zero(2 * capacity)),
+        ring_mask_(2 * capacity - 1),
+        empty_(2 * capacity - 1),
+        entries_(std::make_unique<std::atomic<uint64_t>[]>(2 * capacity)) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("Queue size must be a power of two.");
+        }
+        for (std::size_t i = 0; i <= ring_mask_; ++i) {
+            entries_[i].store(pack(0, true, empty_),
+                              std::memory_order_relaxed);
+        }
+        head_.store(2 * capacity, std::memory_order_relaxed);
+        tail_.store(2 * capacity, std::memory_order_relaxed);
+        threshold_.store(-1, std::memory_order_relaxed);
+    }
+
+    SCQRing(const SCQRing &)            = delete;
+    SCQRing &operator=(const SCQRing &) = delete;
+
+    // `value` must be below capacity() and not already in the ring, which
+    // keeps the ring from ever filling up.
+    void enqueue(std::size_t value) {
+        while (true) {
+            uint64_t tail  = tail_.fetch_add(1, std::memory_order_acq_rel);
+            uint64_t cycle = cycle_of(tail);
+            auto    &entry = entries_[remap(tail)];
+            uint64_t seen  = entry.load(std::memory_order_acquire);
+            while (cycle_before(entry_cycle(seen), cycle) &&
+                   index_of(seen) == empty_ &&
+                   (is_safe(seen) ||
+                    head_.load(std::memory_order_acquire) <= tail)) {
+                if (entry.compare_exchange_weak(seen,
+                                                pack(cycle, true, value),
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+                    if (threshold_.load(std::memory_order_relaxed) !=
+                        reset_threshold()) {
+                        threshold_.store(reset_threshold(),
+                                         std::memory_order_release);
+                    }
+                    return;
+                }
+            }
+        }
+    }
+
+    std::optional<std::size_t> dequeue() {
+        if (threshold_.load(std::memory_order_acquire) < 0) {
+            return std::nullopt;
+        }
+        while (true) {
+            uint64_t head  = head_.fetch_add(1, std::memory_order_acq_rel);
+            uint64_t cycle = cycle_of(head);
+            auto    &entry = entries_[remap(head)];
+            uint64_t seen  = entry.load(std::memory_order_acquire);
+            while (true) {
+                if (entry_cycle(seen) == cycle) {
+                    // Ours; clear the value but keep cycle and safe bit.
+                    entry.fetch_or(empty_, std::memory_order_acq_rel);
+                    return index_of(seen);
+                }
+                uint64_t next = pack(entry_cycle(seen), false, index_of(seen));
+                if (index_of(seen) == empty_) {
+                    next = pack(cycle, is_safe(seen), empty_);
+                }
+                if (!cycle_before(entry_cycle(seen), cycle) ||
+                    entry.compare_exchange_weak(seen,
+                                                next,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+                    break;
+                }
+            }
+            uint64_t tail = tail_.load(std::memory_order_acquire);
+            if (tail <= head + 1) {
+                catch_up(tail, head + 1);
+                threshold_.fetch_sub(1, std::memory_order_acq_rel);
+                return std::nullopt;
+            }
+            if (threshold_.fetch_sub(1, std::memory_order_acq_rel) <= 0) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    std::size_t capacity() const {
+        return capacity_;
+    }
+
+    // A snapshot; consumers that overshot an empty ring may briefly make
+    // the positions disagree.
+    std::size_t size() const {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? std::min<std::size_t>(tail - head, capacity_) : 0;
+    }
+
+private:
+
+    // Cycles are compared modulo the bits left for them in an entry.
+    uint64_t cycle_of(uint64_t position) const {
+        return (position >> order_) << (order_ + 1) >> (order_ + 1);
+    }
+
+    bool cycle_before(uint64_t a, uint64_t b) const {
+        return static_cast<int64_t>((a - b) << (order_ + 1)) < 0;
+    }
+
+    uint64_t pack(uint64_t cycle, bool safe, uint64_t index) const {
+        return (cycle << (order_ + 1)) | (uint64_t(!safe) << order_) | index;
+    }
+
+    uint64_t entry_cycle(uint64_t entry) const {
+        return entry >> (order_ + 1);
+    }
+
+    bool is_safe(uint64_t entry) const {
+        return ((entry >> order_) & 1) == 0;
+    }
+
+    uint64_t index_of(uint64_t entry) const {
+        return entry & ring_mask_;
+    }
+
+    int64_t reset_threshold() const {
+        return static_cast<int64_t>(3 * capacity_ - 1);
+    }
+
+    // Spread consecutive positions over different cache lines.
+    std::size_t remap(uint64_t position) const {
+        std::size_t i = position & ring_mask_;
+        if (order_ <= kRemapBits) {
+            return i;
+        }
+        return ((i >> (order_ - kRemapBits)) | (i << kRemapBits)) & ring_mask_;
+    }
+
+    // Consumers ran past an empty ring; pull the tail up behind them.
+    void catch_up(uint64_t tail, uint64_t head) {
+        while (!tail_.compare_exchange_weak(tail,
+                                            head,
+                                            std::memory_order_acq_rel)) {
+            head = head_.load(std::memory_order_acquire);
+            tail = tail_.load(std::memory_order_acquire);
+            if (tail >= head) {
+                break;
+            }
+        }
+    }
+
+    const std::size_t                       capacity_;
+    const unsigned                          order_;
+    const uint64_t                          ring_mask_;
+    const uint64_t                          empty_;
+    std::unique_ptr<std::atomic<uint64_t>[]> entries_;
+    alignas(64) std::atomic<uint64_t>       head_;
+    alignas(64) std::atomic<uint64_t>       tail_;
+    alignas(64) std::atomic<int64_t>        threshold_;
+};
+
+// Bounded MPMC queue built from two SCQRings over an array of cells: one
+// ring holds the indices of free cells, the other those of filled cells in
+// FIFO order. Both sides claim their position with fetch_add, so the
+// throughput does not collapse under many producers the way a CAS on a
+// shared index does. Drop-in for MPMCQueue as a ThreadPool task queue.
+template <typename Tp_>
+    requires std::is_move_constructible_v<Tp_> ||
+             std::is_copy_constructible_v<Tp_>
+class SCQueue {
+    struct alignas(64) Cell {
+        alignas(Tp_) unsigned char storage[sizeof(Tp_)];
+
+        Tp_ *value() {
+            return std::launder(reinterpret_cast<Tp_ *>(storage));
+        }
+    };
+
+public:
+
+    explicit SCQueue(std::size_t queue_size) :
+        free_(queue_size),
+        filled_(queue_size),
+        cells_(std::make_unique<Cell[]>(queue_size)) {
+        for (std::size_t i = 0; i < queue_size; ++i) {
+            free_.enqueue(i);
+        }
+    }
+
+    ~SCQueue() {
+        if constexpr (!std::is_trivially_destructible_v<Tp_>) {
+            while (consume([](Tp_ &&) {})) {}
+        }
+    }
+
+    SCQueue(const SCQueue &)            = delete;
+    SCQueue &operator=(const SCQueue &) = delete;
+
+    // On failure `value` is left untouched, so the caller can retry with it.
+    [[nodiscard]] bool enqueue(Tp_ &&value) {
+        return emplace(std::move(value));
+    }
+
+    [[nodiscard]] bool enqueue(const Tp_ &value) {
+        return emplace(value);
+    }
+
+    template <typename... Args>
+        requires std::constructible_from<Tp_, Args...>
+    [[nodiscard]] bool emplace(Args &&...args) {
+        std::optional<std::size_t> index = free_.dequeue();
+        if (!index) {
+            return false;  // Queue is full
+        }
+        try {
+            std::construct_at(cells_[*index].value(),
+                              std::forward<Args>(args)...);
+        } catch (...) {
+            free_.enqueue(*index);
+            throw;
+        }
+        filled_.enqueue(*index);
+        return true;
+    }
+
+    [[nodiscard]] bool dequeue(Tp_ &value) {
+        return consume([&value](Tp_ &&item) { value = std::move(item); });
+    }
+
+    std::optional<Tp_> try_dequeue() {
+        std::optional<Tp_> result;
+        consume([&result](Tp_ &&item) { result.emplace(std::move(item)); });
+        return result;
+    }
+
+    // As MPMCQueue::consume(): `func` sees the element in its cell.
+    template <typename Func>
+        requires std::invocable<Func, Tp_ &&>
+    bool consume(Func &&func) {
+        std::optional<std::size_t> index = filled_.dequeue();
+        if (!index) {
+            return false;
+        }
+        struct Release {
+            SCQueue    *queue;
+            std::size_t index;
+
+            ~Release() {
+                std::destroy_at(queue->cells_[index].value());
+                queue->free_.enqueue(index);
+            }
+        } release {this, *index};
+        std::invoke(std::forward<Func>(func),
+                    std::move(*cells_[*index].value()));
+        return true;
+    }
+
+    std::size_t capacity() const {
+        return filled_.capacity();
+    }
+
+    std::size_t size() const {
+        return filled_.size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+private:
+    SCQRing                 free_;
+    SCQRing                 filled_;
+    std::unique_ptr<Cell[]> cells_;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_SCQ_QUEUE_H
@@ -0,0 +1,144 @@
+#ifndef LC_SHARDED_QUEUE_H
+#define LC_SHARDED_QUEUE_H
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "lc_config.h"
+#include "lc_mpmc_queue.h"
+
+LC_NAMESPACE_BEGIN
+
+// Injection queue split into independent MPMCQueue shards, so producers on
+// different threads mostly claim cells on different cache lines instead
+// of all contending on one enqueue index. Each producer thread has a home
+// shard (threads are numbered in the order they first push) and only
+// spills into the others when it is full. Consumers scan every shard,
+// starting one past the shard they last took from, so no shard starves.
+//
+// Order is FIFO per shard, and therefore per producer as long as its home
+// shard does not overflow, but only approximate across producers.
+template <typename Tp_>
+class ShardedQueue {
+public:
+    static constexpr std::size_t kDefaultShards = 8;
+
+    // `queue_size` is split evenly; each shard must come out a power of two
+    // of at least 2.
+    explicit ShardedQueue(std::size_t queue_size,
+                          std::size_t shard_count = kDefaultShards) {
+        if (shard_count == 0 || queue_size % shard_count != 0) {
+            throw std::invalid_argument(
+                "Queue size must be a multiple of the shard count.");
+        }
+        shards_.reserve(shard_count);
+        for (std::size_t i = 0; i < shard_count; ++i) {
+            shards_.push_back(
+                std::make_unique<MPMCQueue<Tp_>>(queue_size / shard_count));
+        }
+    }
+
+    ShardedQueue(const ShardedQueue &)            = delete;
+    ShardedQueue &operator=(const ShardedQueue &) = delete;
+
+    // On failure `value` is left untouched, so the caller can retry with it.
+    [[nodiscard]] bool enqueue(Tp_ &&value) {
+        return emplace(std::move(value));
+    }
+
+    [[nodiscard]] bool enqueue(const Tp_ &value) {
+        return emplace(value);
+    }
+
+    // Fails only when every shard is full.
+    template <typename... Args>
+        requires std::constructible_from<Tp_, Args...>
+    [[nodiscard]] bool emplace(Args &&...args) {
+        std::size_t home = producer_id() % shards_.size();
+        for (std::size_t i = 0; i < shards_.size(); ++i) {
+            auto &shard = *shards_[(home + i) % shards_.size()];
+            // Args are only consumed by the emplace that succeeds.
+            if (shard.emplace(std::forward<Args>(args)...)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] bool dequeue(Tp_ &value) {
+        return consume([&value](Tp_ &&item) { value = std::move(item); });
+    }
+
+    std::optional<Tp_> try_dequeue() {
+        std::optional<Tp_> result;
+        consume([&result](Tp_ &&item) { result.emplace(std::move(item)); });
+        return result;
+    }
+
+    template <typename Func>
+        requires std::invocable<Func, Tp_ &&>
+    bool consume(Func &&func) {
+        std::size_t start = consumer_cursor_;
+        for (std::size_t i = 0; i < shards_.size(); ++i) {
+            std::size_t index = (start + i) % shards_.size();
+            if (shards_[index]->consume(func)) {
+                consumer_cursor_ = index + 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::size_t shard_count() const {
+        return shards_.size();
+    }
+
+    std::size_t capacity() const {
+        return shards_.size() * shards_.front()->capacity();
+    }
+
+    std::size_t size() const {
+        std::size_t total = 0;
+        for (const auto &shard : shards_) {
+            total += shard->size();
+        }
+        return total;
+    }
+
+    bool empty() const {
+        for (const auto &shard : shards_) {
+            if (!shard->empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+
+    static std::size_t producer_id() {
+        if (producer_id_ == 0) {
+            producer_id_ =
+                next_producer_id_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return producer_id_;
+    }
+
+    std::vector<std::unique_ptr<MPMCQueue<Tp_>>> shards_;
+
+    // Per thread, shared by all queues; both are only placement hints.
+    static inline std::atomic<std::size_t>    next_producer_id_ {1};
+    static inline LC_THREAD_LOCAL std::size_t producer_id_     = 0;
+    static inline LC_THREAD_LOCAL std::size_t consumer_cursor_ = 0;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_SHARDED_QUEUE_H
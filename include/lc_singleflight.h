@@ -0,0 +1,147 @@
+#ifndef LC_SINGLEFLIGHT_H
+#define LC_SINGLEFLIGHT_H
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+// In-flight call coalescing after Go's singleflight: while a computation
+// for a key is queued or running, later requests for that key share its
+// future instead of starting another. Once it finishes the key is free
+// again, so results are not cached.
+//
+// Keys live in a map split into shards, each behind its own mutex, so
+// requests for different keys rarely touch the same lock. The lock is only
+// held to look up, insert or erase a key, never while the work runs. The
+// group must outlive the flights it starts.
+template <typename Key, typename Result, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class SingleFlight {
+    struct alignas(64) Shard {
+        std::mutex mtx;
+        std::unordered_map<Key, std::shared_future<Result>, Hash, KeyEqual>
+            flights;
+    };
+
+    // Owned by the callable handed to `launch`. Frees the key once the
+    // result is published, or when the callable dies without running.
+    struct Flight {
+        Flight(SingleFlight *owner, const Key &key) : owner(owner), key(key) {}
+
+        ~Flight() {
+            finish();
+        }
+
+        // The result is already published, so a request arriving before
+        // the erase still gets a ready future.
+        void finish() {
+            if (!std::exchange(finished, true)) {
+                owner->erase(key);
+            }
+        }
+
+        SingleFlight        *owner;
+        Key                  key;
+        std::promise<Result> promise;
+        bool                 finished = false;
+    };
+
+public:
+    static constexpr std::size_t kDefaultShards = 16;
+
+    explicit SingleFlight(std::size_t shard_count = kDefaultShards) :
+        shard_count_(shard_count) {
+        if (shard_count == 0) {
+            throw std::invalid_argument("Shard count must be positive.");
+        }
+        shards_ = std::make_unique<Shard[]>(shard_count);
+    }
+
+    SingleFlight(const SingleFlight &)            = delete;
+    SingleFlight &operator=(const SingleFlight &) = delete;
+
+    // Join the flight for `key`, or start one by passing `launch` a void()
+    // callable that computes `func()`, publishes the result and frees the
+    // key. `launch` runs it somewhere, e.g. by submitting it to a pool. If
+    // `launch` throws, every caller that joined sees the exception; if the
+    // callable is destroyed without running, they see broken_promise.
+    template <typename Func, typename Launch>
+        requires std::is_invocable_r_v<Result, std::decay_t<Func> &>
+    std::shared_future<Result> start(const Key &key,
+                                     Func    &&func,
+                                     Launch  &&launch) {
+        auto flight = std::make_shared<Flight>(this, key);
+        auto future = flight->promise.get_future().share();
+        {
+            Shard                       &shard = shard_for(key);
+            std::scoped_lock<std::mutex> lock(shard.mtx);
+            auto [it, inserted] = shard.flights.try_emplace(key, future);
+            if (!inserted) {
+                flight->finished = true;  // Never registered
+                return it->second;
+            }
+        }
+        auto body = [flight, func = std::forward<Func>(func)]() mutable {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    func();
+                    flight->promise.set_value();
+                } else {
+                    flight->promise.set_value(func());
+                }
+            } catch (...) {
+                flight->promise.set_exception(std::current_exception());
+            }
+            flight->finish();
+        };
+        try {
+            std::invoke(std::forward<Launch>(launch), std::move(body));
+        } catch (...) {
+            flight->promise.set_exception(std::current_exception());
+            flight->finish();
+            throw;
+        }
+        return future;
+    }
+
+    // Keys with a computation queued or running; approximate while flights
+    // start or finish.
+    std::size_t in_flight() const {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < shard_count_; ++i) {
+            std::scoped_lock<std::mutex> lock(shards_[i].mtx);
+            total += shards_[i].flights.size();
+        }
+        return total;
+    }
+
+private:
+
+    Shard &shard_for(const Key &key) const {
+        return shards_[Hash {}(key) % shard_count_];
+    }
+
+    void erase(const Key &key) {
+        Shard                       &shard = shard_for(key);
+        std::scoped_lock<std::mutex> lock(shard.mtx);
+        shard.flights.erase(key);
+    }
+
+    std::size_t              shard_count_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_SINGLEFLIGHT_H
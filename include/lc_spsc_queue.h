@@ -0,0 +1,113 @@
+#ifndef LC_SPSC_QUEUE_H
+#define LC_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+// Bounded single-producer, single-consumer ring. Exactly one thread may
+// enqueue and one (possibly different) thread may dequeue. Each side keeps
+// a private copy of the other's index and only reloads it when the ring
+// looks full or empty, so a steady stream touches the shared indices once
+// per wrap-around rather than once per element.
+template <typename Tp_>
+    requires std::is_move_constructible_v<Tp_>
+class SPSCQueue {
+    struct Slot {
+        alignas(Tp_) unsigned char storage[sizeof(Tp_)];
+
+        Tp_ *value() {
+            return std::launder(reinterpret_cast<Tp_ *>(storage));
+        }
+    };
+
+public:
+
+    explicit SPSCQueue(std::size_t queue_size) :
+        mask_(queue_size - 1),
+        slots_(std::make_unique<Slot[]>(queue_size)) {
+        if (queue_size < 2 || (queue_size & mask_) != 0) {
+            throw std::invalid_argument("Queue size must be a power of two.");
+        }
+    }
+
+    ~SPSCQueue() {
+        if constexpr (!std::is_trivially_destructible_v<Tp_>) {
+            while (try_dequeue()) {}
+        }
+    }
+
+    SPSCQueue(const SPSCQueue &)            = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    // On failure `value` is left untouched, so the caller can retry with it.
+    [[nodiscard]] bool enqueue(Tp_ &&value) {
+        return emplace(std::move(value));
+    }
+
+    template <typename... Args>
+        requires std::constructible_from<Tp_, Args...>
+    [[nodiscard]] bool emplace(Args &&...args) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ > mask_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ > mask_) {
+                return false;  // Queue is full
+            }
+        }
+        std::construct_at(slots_[head & mask_].value(),
+                          std::forward<Args>(args)...);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<Tp_> try_dequeue() {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_) {
+                return std::nullopt;
+            }
+        }
+        Tp_               *item = slots_[tail & mask_].value();
+        std::optional<Tp_> result(std::move(*item));
+        std::destroy_at(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        return result;
+    }
+
+    std::size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    // Exact from either end; a snapshot from any other thread.
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) ==
+               tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    const std::size_t       mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    // Producer side: its index and its view of the consumer's.
+    alignas(64) std::atomic<std::size_t> head_ {0};
+    std::size_t                          cached_tail_ = 0;
+
+    // Consumer side.
+    alignas(64) std::atomic<std::size_t> tail_ {0};
+    std::size_t                          cached_head_ = 0;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_SPSC_QUEUE_H
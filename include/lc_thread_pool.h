@@ -1,42 +1,262 @@
 #ifndef LC_THREAD_POOL_H
 #define LC_THREAD_POOL_H
 
+#include <algorithm>
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <concepts>
+#include <condition_variable>
 #include <cstddef>
+#include <climits>
+#include <cstdint>
+#include <exception>
 #include <functional>
 #include <future>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <thread>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "lc_admission_controller.h"
+#include "lc_bump_arena.h"
+#include "lc_codel.h"
+#include "lc_concurrency_limiter.h"
 #include "lc_config.h"
 #include "lc_context.h"
+#include "lc_futex.h"
 #include "lc_mpmc_queue.h"
+#include "lc_pool_config.h"
+#include "lc_rate_limiter.h"
+#include "lc_singleflight.h"
+#include "lc_timer_queue.h"
 #include "lc_wait_strategy.h"
 
 LC_NAMESPACE_BEGIN
 
+// The task queue is any bounded MPMC queue template with enqueue(T&&) and
+// try_dequeue() (MPMCQueue, or SCQueue for many concurrent submitters).
+template <typename Queue, typename Tp_>
+concept TaskQueueOf = requires(Queue &queue, Tp_ &&task) {
+    { queue.enqueue(std::move(task)) } -> std::same_as<bool>;
+    { queue.try_dequeue() } -> std::same_as<std::optional<Tp_>>;
+};
+
+// Thread pool whose policies come from a compile-time Config; see
+// DefaultPoolConfig. Most code uses the ThreadPool alias below.
 template <size_t PoolSize, typename Meta = EmptyMetadata,
-          typename WaitStrategy = AtomicWaitStrategy>
-    requires std::derived_from<WaitStrategy, WaitStrategyBase>
-class ThreadPool {
-    using InternalTask = Context<Meta, std::function<void()>>;
+          ThreadPoolConfig Config = DefaultPoolConfig>
+    requires TaskQueueOf<
+        typename Config::template Queue<
+            Context<Meta, TaskFunction<Config::kTaskStorageSize>>>,
+        Context<Meta, TaskFunction<Config::kTaskStorageSize>>>
+class BasicThreadPool {
+public:
+    using Task         = Context<Meta, TaskFunction<Config::kTaskStorageSize>>;
+    using TaskQueue    = typename Config::template Queue<Task>;
+    using WaitStrategy = typename Config::WaitStrategy;
+
+private:
+    using InternalTask = Task;
+
+    static constexpr bool kWorkerQueues = Config::kWorkerQueueSize > 0;
+    static constexpr bool kTiered       = Config::kHotWorkers > 0;
+
+    // Per-worker bookkeeping for the monitor, one cache line each. Workers
+    // only write it while monitoring is enabled.
+    struct alignas(64) WorkerSlot {
+        std::atomic<int64_t>      task_started_ns {0};  // 0 while idle
+        std::atomic<const Meta *> metadata {nullptr};
+        std::atomic<uint32_t>     readers {0};
+        std::atomic<bool>         in_region {false};
+        std::atomic<bool>         presumed_blocked {false};
+    };
+
+    // Only instantiated as a member when Config::kMetrics is set.
+    struct alignas(64) MetricCounters {
+        std::atomic<size_t>  submitted {0};
+        std::atomic<size_t>  rejected {0};
+        std::atomic<size_t>  completed {0};
+        std::atomic<int64_t> busy_ns {0};
+    };
+
+    struct Disabled {};
+
+    struct LocalBase {
+        virtual ~LocalBase() = default;
+    };
+
+    template <typename T>
+    struct LocalValue : LocalBase {
+        T value;
+    };
+
+    // Owned by the stack of the thread it belongs to, so locals and arena
+    // memory are allocated and freed on that thread only.
+    struct WorkerStorage {
+        explicit WorkerStorage(size_t arena_block_size) :
+            arena(arena_block_size) {}
+
+        BumpArena                               arena;
+        std::vector<std::unique_ptr<LocalBase>> locals;  // By local_id<T>()
+    };
+
+    // Idle-worker tiers; only instantiated when Config::kHotWorkers is set.
+    struct alignas(64) Tiers {
+        std::atomic<size_t>   spinning {0};  // Hot and idle
+        std::atomic<size_t>   parked {0};
+        std::atomic<uint32_t> epoch {0};  // Parked workers wait on it
+        // Queued but not yet taken. Counted before the push, so take()
+        // never drives it below the real depth.
+        alignas(64) std::atomic<size_t> queued {0};
+    };
+
+    // Only instantiated when Config::kWorkerQueueSize is set. Others steal
+    // from the queue only while its owner is Busy; an Idle or Parked owner
+    // comes back for it itself.
+    enum class Owner : uint8_t {
+        Busy,
+        Idle,    // Out of tasks, re-checking the queues
+        Parked,  // Asleep on `wake`
+    };
+
+    struct alignas(64) WorkerQueue {
+        MPMCQueue<InternalTask> queue {Config::kWorkerQueueSize};
+        std::atomic<Owner>      owner {Owner::Idle};
+        std::atomic<uint32_t>   wake {0};
+    };
+
+    struct CompensationWorker {
+        std::thread       thread;
+        std::atomic<bool> finished {false};
+    };
+
 public:
 
-    ThreadPool(std::shared_ptr<MPMCQueue<InternalTask>> task_queue) {
+    // Upper bound on extra threads started to cover blocked workers.
+    static constexpr size_t kMaxCompensationWorkers = PoolSize;
+
+    // How long a retired compensation thread stays parked for reuse before
+    // it exits.
+    static constexpr std::chrono::milliseconds kCompensationLinger {1000};
+
+    // Task classes accepted by set_concurrency_limit().
+    static constexpr size_t kMaxTaskClasses = 64;
+
+    // A task the watchdog found running past its threshold. `metadata` is
+    // only valid for the duration of the callback.
+    struct StuckTask {
+        size_t                   worker;
+        const Meta              &metadata;
+        std::chrono::nanoseconds elapsed;
+    };
+
+    using WatchdogCallback = std::function<void(const StuckTask &)>;
+
+    // Totals kept when Config::kMetrics is set; see metrics().
+    struct Metrics {
+        size_t                   submitted;  // Accepted, including deferred
+        size_t                   rejected;   // Turned away or queue full
+        size_t                   completed;
+        std::chrono::nanoseconds busy_time;  // Summed over all tasks
+    };
+
+    enum class TraceEvent {
+        Submitted,  // About to be queued; Rejected follows if it is full
+        Rejected,
+        Started,
+        Finished,
+        Dropped  // By CoDel, instead of Started
+    };
+
+    // `worker` is kNoWorker for tasks run outside the fixed workers, and
+    // `metadata` is only valid for the duration of the callback.
+    struct TraceRecord {
+        TraceEvent  event;
+        const Meta &metadata;
+        size_t      worker;
+        int64_t     time_ns;  // steady clock
+    };
+
+    using TraceCallback = std::function<void(const TraceRecord &)>;
+
+    static constexpr size_t kNoWorker = static_cast<size_t>(-1);
+
+    // Runs on each worker thread before it takes tasks, with the worker's
+    // index (kNoWorker on compensation workers). It may call pool.local()
+    // to set up worker-local state and must not throw.
+    using WorkerInit =
+        std::function<void(BasicThreadPool &pool, size_t worker)>;
+
+    // RAII marker returned by blocking_region(). It must be destroyed on the
+    // thread that created it.
+    class BlockingRegion {
+    public:
+        BlockingRegion(BlockingRegion &&other) noexcept :
+            pool_(std::exchange(other.pool_, nullptr)) {}
+
+        BlockingRegion(const BlockingRegion &)            = delete;
+        BlockingRegion &operator=(const BlockingRegion &) = delete;
+        BlockingRegion &operator=(BlockingRegion &&)      = delete;
+
+        ~BlockingRegion() {
+            if (pool_ != nullptr) {
+                pool_->leave_blocking_region();
+            }
+        }
+
+    private:
+        friend class BasicThreadPool;
+
+        explicit BlockingRegion(BasicThreadPool *pool) : pool_(pool) {}
+
+        BasicThreadPool *pool_;
+    };
+
+    BasicThreadPool(std::shared_ptr<TaskQueue> task_queue) :
+        BasicThreadPool(std::move(task_queue),
+                        std::make_shared<WaitStrategy>()) {}
+
+    BasicThreadPool(std::shared_ptr<TaskQueue> task_queue,
+                    WorkerInit                 worker_init) :
+        BasicThreadPool(std::move(task_queue),
+                        std::make_shared<WaitStrategy>(),
+                        std::move(worker_init)) {}
+
+    // Share a wait strategy with the caller, e.g. to register descriptors
+    // with a ReactorWaitStrategy the workers poll.
+    BasicThreadPool(std::shared_ptr<TaskQueue>    task_queue,
+                    std::shared_ptr<WaitStrategy> wait_strategy,
+                    WorkerInit                    worker_init = {}) :
+        worker_init_(std::move(worker_init)) {
         state_.store(State::Initializing, std::memory_order_relaxed);
-        active_tasks_.store(0, std::memory_order_relaxed);
+        blocked_workers_.store(0, std::memory_order_relaxed);
+        compensation_workers_.store(0, std::memory_order_relaxed);
+        compensation_lingering_.store(0, std::memory_order_relaxed);
+        compensation_claims_.store(0, std::memory_order_relaxed);
+        compensation_signal_.store(0, std::memory_order_relaxed);
+        idle_workers_.store(0, std::memory_order_relaxed);
+        monitoring_.store(false, std::memory_order_relaxed);
         task_queue_    = std::move(task_queue);
-        wait_strategy_ = std::make_shared<WaitStrategy>();
+        wait_strategy_ = std::move(wait_strategy);
         launch_all_workers();
         state_.store(State::Running, std::memory_order_release);
     }
 
-    ~ThreadPool() {
+    ~BasicThreadPool() {
         shutdown();
+        for (auto &limiter : class_limiters_) {
+            delete limiter.load(std::memory_order_relaxed);
+        }
+        for (auto &bucket : rate_limiters_) {
+            delete bucket.load(std::memory_order_relaxed);
+        }
+        delete admission_.load(std::memory_order_relaxed);
+        delete codel_.load(std::memory_order_relaxed);
     }
 
     template <std::invocable Func>
@@ -53,13 +273,8 @@ public:
 
         auto future = task_ptr->get_future();
 
-        InternalTask task {std::forward<Ctx>(ctx),
-                           [task_ptr]() mutable { (*task_ptr)(); }};
-        if (!task_queue_->enqueue(std::move(task))) {
-            throw std::runtime_error("Failed to enqueue task");
-        }
-
-        wait_strategy_->notify();
+        submit_task(InternalTask {std::forward<Ctx>(ctx),
+                                  [task_ptr]() mutable { (*task_ptr)(); }});
         return future;
     }
 
@@ -81,57 +296,1409 @@ public:
             std::bind(std::forward<Func>(func), std::forward<Args>(args)...);
         auto task_ptr = std::make_shared<std::packaged_task<ResultType()>>(
             std::move(bound_func));
+        auto future = task_ptr->get_future();
+        submit_task(InternalTask {std::forward<Ctx>(ctx),
+                                  [task_ptr]() mutable { (*task_ptr)(); }});
+        return future;
+    }
+
+    // Queue `func` on the given worker's own queue, so tasks touching the
+    // same data keep running on the same core. An idle worker may steal it
+    // while that worker is busy, and a full worker queue sends it to the
+    // shared queue instead.
+    template <std::invocable Func>
+        requires(Config::kWorkerQueueSize > 0)
+    auto submit_to(size_t worker, Func &&func)
+        -> std::future<std::invoke_result_t<Func>> {
+        return submit_to(worker, EmptyMetadata {}, std::forward<Func>(func));
+    }
+
+    template <typename Ctx, std::invocable Func>
+        requires(Config::kWorkerQueueSize > 0)
+    auto submit_to(size_t worker, Ctx &&ctx, Func &&func)
+        -> std::future<std::invoke_result_t<Func>> {
+        if (worker >= PoolSize) {
+            throw std::out_of_range("Worker index out of range");
+        }
+        using ResultType = std::invoke_result_t<Func>;
+        auto task_ptr    = std::make_shared<std::packaged_task<ResultType()>>(
+            std::forward<Func>(func));
+        auto future = task_ptr->get_future();
+        submit_task(InternalTask {std::forward<Ctx>(ctx),
+                                  [task_ptr]() mutable { (*task_ptr)(); }},
+                    worker);
+        return future;
+    }
+
+    // Like submit(), but returns an empty optional instead of throwing when
+    // admission control or a full queue turns the task away.
+    template <std::invocable Func>
+    auto try_submit(Func &&func)
+        -> std::optional<std::future<std::invoke_result_t<Func>>> {
+        return try_submit(EmptyMetadata {}, std::forward<Func>(func));
+    }
+
+    template <typename Ctx, std::invocable Func>
+    auto try_submit(Ctx &&ctx, Func &&func)
+        -> std::optional<std::future<std::invoke_result_t<Func>>> {
+        using ResultType = std::invoke_result_t<Func>;
+        auto task_ptr    = std::make_shared<std::packaged_task<ResultType()>>(
+            std::forward<Func>(func));
         auto         future = task_ptr->get_future();
         InternalTask task {std::forward<Ctx>(ctx),
                            [task_ptr]() mutable { (*task_ptr)(); }};
-        if (!task_queue_->enqueue(std::move(task))) {
+        if (!offer_task(std::move(task))) {
+            return std::nullopt;
+        }
+        return future;
+    }
+
+    // Submit `func` unless a task for `key` started through `flights` is
+    // still queued or running; then share that task's result instead. See
+    // SingleFlight.
+    template <typename Key, typename Result, typename Hash, typename KeyEqual,
+              std::invocable Func>
+    std::shared_future<Result>
+    submit_dedup(SingleFlight<Key, Result, Hash, KeyEqual> &flights,
+                 const std::type_identity_t<Key>           &key,
+                 Func                                     &&func) {
+        return submit_dedup(flights,
+                            key,
+                            EmptyMetadata {},
+                            std::forward<Func>(func));
+    }
+
+    template <typename Key, typename Result, typename Hash, typename KeyEqual,
+              typename Ctx, std::invocable Func>
+    std::shared_future<Result>
+    submit_dedup(SingleFlight<Key, Result, Hash, KeyEqual> &flights,
+                 const std::type_identity_t<Key>           &key,
+                 Ctx                                      &&ctx,
+                 Func                                     &&func) {
+        return flights.start(key, std::forward<Func>(func), [&](auto &&body) {
+            submit(std::forward<Ctx>(ctx), std::move(body));
+        });
+    }
+
+    // Enqueue `func` once `delay` has elapsed, using the pool's timer thread
+    // instead of blocking the caller. Tasks still pending at shutdown are
+    // enqueued immediately.
+    template <std::invocable Func>
+        requires std::copy_constructible<Meta>
+    auto submit_after(std::chrono::nanoseconds delay, Func &&func)
+        -> std::future<std::invoke_result_t<Func>> {
+        return submit_after(delay, EmptyMetadata {}, std::forward<Func>(func));
+    }
+
+    template <typename Ctx, std::invocable Func>
+        requires std::copy_constructible<Meta>
+    auto submit_after(std::chrono::nanoseconds delay, Ctx &&ctx, Func &&func)
+        -> std::future<std::invoke_result_t<Func>> {
+        using ResultType = std::invoke_result_t<Func>;
+        auto task_ptr    = std::make_shared<std::packaged_task<ResultType()>>(
+            std::forward<Func>(func));
+        auto future = task_ptr->get_future();
+        InternalTask task {std::forward<Ctx>(ctx),
+                           [task_ptr]() mutable { (*task_ptr)(); }};
+        begin_task();
+        trace(TraceEvent::Submitted, task.metadata, nullptr);
+        if (!defer_task(task, delay)) {
+            trace(TraceEvent::Rejected, task.metadata, nullptr);
+            count(&MetricCounters::rejected);
+            finish_task();
             throw std::runtime_error("Failed to enqueue task");
         }
-        wait_strategy_->notify();
+        count(&MetricCounters::submitted);
         return future;
     }
 
+    // Run `func(i)` for every i in [0, count) from a single queue entry.
+    // Workers claim chunks of `grain` indices from a shared cursor, and
+    // while indices remain each claimer queues one more, up to PoolSize, so
+    // the fan-out takes O(PoolSize) queue slots however large `count` is.
+    // Each of those entries counts as a task in metrics and traces.
+    // `func` may take (begin, end) instead to receive whole chunks. The
+    // future reports the first exception thrown; chunks not yet started are
+    // then skipped. A `grain` of 0 picks about 16 chunks per worker.
+    template <typename Func>
+        requires std::invocable<std::decay_t<Func> &, size_t> ||
+                 std::invocable<std::decay_t<Func> &, size_t, size_t>
+    std::future<void> submit_range(size_t count,
+                                   Func &&func,
+                                   size_t grain = 0) {
+        return submit_range(EmptyMetadata {},
+                            count,
+                            std::forward<Func>(func),
+                            grain);
+    }
+
+    template <typename Ctx, typename Func>
+        requires std::copy_constructible<Meta> &&
+                 (std::invocable<std::decay_t<Func> &, size_t> ||
+                  std::invocable<std::decay_t<Func> &, size_t, size_t>)
+    std::future<void> submit_range(Ctx  &&ctx,
+                                   size_t count,
+                                   Func &&func,
+                                   size_t grain = 0) {
+        using State = RangeState<std::decay_t<Func>>;
+        if (grain == 0) {
+            grain = std::max<size_t>(1, count / (PoolSize * 16));
+        }
+        auto state = std::make_shared<State>(this,
+                                             std::forward<Ctx>(ctx),
+                                             std::forward<Func>(func),
+                                             count,
+                                             grain);
+        auto future = state->promise.get_future();
+        if (count == 0) {
+            state->promise.set_value();
+            return future;
+        }
+        submit_task(InternalTask {state->metadata,
+                                  [state] { run_range(state); }});
+        return future;
+    }
+
+    // The calling worker's instance of T, default-constructed on its first
+    // use there and destroyed when the worker exits. Tasks use it for state
+    // that is expensive to build but must not be shared, e.g. a codec or a
+    // connection. Throws std::logic_error outside this pool's workers.
+    template <typename T>
+        requires std::default_initializable<T>
+    T &local() {
+        auto  &locals = current_storage().locals;
+        size_t id     = local_id<T>();
+        if (id >= locals.size()) {
+            locals.resize(id + 1);
+        }
+        if (!locals[id]) {
+            locals[id] = std::make_unique<LocalValue<T>>();
+        }
+        return static_cast<LocalValue<T> &>(*locals[id]).value;
+    }
+
+    // Scratch memory for the running task. The worker resets it as soon as
+    // the task returns, so nothing allocated from it may outlive the task,
+    // and it is never freed on another thread. Throws std::logic_error
+    // outside this pool's workers.
+    BumpArena &arena() {
+        return current_storage().arena;
+    }
+
+    // Run one queued task on the calling thread, e.g. from an external event
+    // loop woken by EventFdWaitStrategy. Returns false if nothing was queued.
+    bool run_one() {
+        std::optional<InternalTask> task = take(kNoWorker);
+        if (!task) {
+            return false;
+        }
+        execute(*task, nullptr);
+        return true;
+    }
+
+    // Allow at most `limit` tasks whose metadata has `task_class` to run at
+    // once. Excess tasks are parked off the queue rather than occupying a
+    // worker, and start as running ones finish. Set the limit before tasks
+    // of that class are submitted; it cannot be changed afterwards.
+    void set_concurrency_limit(size_t task_class, size_t limit)
+        requires ClassifiedMetadata<Meta>
+    {
+        if (task_class >= kMaxTaskClasses) {
+            throw std::out_of_range("Task class out of range");
+        }
+        auto *limiter = new ConcurrencyLimiter<InternalTask>(limit);
+        ConcurrencyLimiter<InternalTask> *expected = nullptr;
+        if (!class_limiters_[task_class].compare_exchange_strong(
+                expected,
+                limiter,
+                std::memory_order_acq_rel)) {
+            delete limiter;
+            throw std::logic_error("Concurrency limit already set");
+        }
+    }
+
+    // Mark the rest of the current task as potentially blocking. While a
+    // worker is inside the region, the pool runs a compensation worker in
+    // its place so queued tasks keep making progress, unless a fixed worker
+    // is idle and can take them. The compensation worker retires once the
+    // region ends and lingers for kCompensationLinger so the next region
+    // reuses it instead of starting a thread. Regions nest; outside of a
+    // pool worker this is a no-op.
+    [[nodiscard]] BlockingRegion blocking_region() {
+        if (current_pool_ != this) {
+            return BlockingRegion(nullptr);
+        }
+        if (region_depth_++ == 0) {
+            enter_blocking();
+        }
+        return BlockingRegion(this);
+    }
+
+    // Start a monitor that treats a worker stuck in one task for longer than
+    // `threshold` as blocked and compensates for it until the task returns.
+    // Calling it again only updates the threshold.
+    void enable_blocking_detection(std::chrono::nanoseconds threshold) {
+        std::scoped_lock<std::mutex> lock(monitor_mtx_);
+        blocking_threshold_ = threshold;
+        start_monitor();
+    }
+
+    // Start a watchdog that reports every task still running after
+    // `threshold`, once per task, by calling `callback` on the monitor
+    // thread. The stuck worker cannot finish its task while the callback
+    // inspects it, so keep the callback short. Calling it again replaces
+    // the threshold and callback.
+    void enable_watchdog(std::chrono::nanoseconds threshold,
+                         WatchdogCallback         callback) {
+        std::scoped_lock<std::mutex> lock(monitor_mtx_);
+        watchdog_threshold_ = threshold;
+        watchdog_callback_  = std::move(callback);
+        start_monitor();
+    }
+
+    // Admit tasks whose metadata has `task_class` at no more than
+    // `tasks_per_second`, allowing bursts of `burst`. Submissions over the
+    // rate return immediately and are enqueued by the timer thread once
+    // their token is due. Set the rate before tasks of that class are
+    // submitted; it cannot be changed afterwards.
+    void set_rate_limit(size_t task_class,
+                        double tasks_per_second,
+                        size_t burst = 1)
+        requires ClassifiedMetadata<Meta> && std::copy_constructible<Meta>
+    {
+        if (task_class >= kMaxTaskClasses) {
+            throw std::out_of_range("Task class out of range");
+        }
+        auto        *bucket   = new TokenBucket(tasks_per_second, burst);
+        TokenBucket *expected = nullptr;
+        if (!rate_limiters_[task_class].compare_exchange_strong(
+                expected,
+                bucket,
+                std::memory_order_acq_rel)) {
+            delete bucket;
+            throw std::logic_error("Rate limit already set");
+        }
+    }
+
+    // Bound the tasks in flight by an AIMD limit driven by queueing latency,
+    // so that overload is shed at submission instead of building a backlog.
+    // Rejected submissions make submit() throw and try_submit() return an
+    // empty optional. Tasks deferred by a rate limit are already paced; they
+    // are counted in flight but never rejected. The limit never drops below
+    // PoolSize, since that many tasks need not queue at all. Enable it
+    // before submitting; it cannot be changed later.
+    void set_admission_control(AdmissionOptions options = {}) {
+        options.min_limit =
+            std::max(options.min_limit, std::min(PoolSize, options.max_limit));
+        options.initial_limit = std::max(options.initial_limit,
+                                         options.min_limit);
+        auto                *controller = new AdmissionController(options);
+        AdmissionController *expected   = nullptr;
+        if (!admission_.compare_exchange_strong(expected,
+                                                controller,
+                                                std::memory_order_acq_rel)) {
+            delete controller;
+            throw std::logic_error("Admission control already set");
+        }
+    }
+
+    // The current admission limit, or 0 without admission control.
+    size_t admission_limit() const {
+        auto *controller = admission_.load(std::memory_order_acquire);
+        return controller == nullptr ? 0 : controller->limit();
+    }
+
+    // Shed load by queueing delay: once the shortest wait over an interval
+    // stays above the target, tasks that waited more than twice the target
+    // are dropped instead of run, and their futures report
+    // std::future_errc::broken_promise. Time spent parked behind a
+    // concurrency limit counts as waiting. Enable it before submitting; it
+    // cannot be changed later.
+    void set_codel(const CodelOptions &options = {}) {
+        auto  *codel    = new Codel(options);
+        Codel *expected = nullptr;
+        if (!codel_.compare_exchange_strong(expected,
+                                            codel,
+                                            std::memory_order_acq_rel)) {
+            delete codel;
+            throw std::logic_error("CoDel already set");
+        }
+    }
+
+    // Block until every accepted task has finished, including tasks still
+    // waiting on a delay or rate limit and chunks of submit_range(). Tasks
+    // submitted meanwhile extend the wait. Throws std::logic_error when
+    // called from a task of this pool, which could never see it idle.
+    void wait_idle() {
+        check_not_in_pool();
+        while (outstanding_.load(std::memory_order_acquire) != 0) {
+            uint32_t epoch = idle_epoch_.load(std::memory_order_acquire);
+            idle_waiters_.fetch_add(1, std::memory_order_seq_cst);
+            if (outstanding_.load(std::memory_order_seq_cst) != 0) {
+                futex_wait(idle_epoch_, epoch);
+            }
+            idle_waiters_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    // As wait_idle(), but gives up after `timeout`. Returns true if the pool
+    // was idle.
+    bool wait_idle_for(std::chrono::nanoseconds timeout) {
+        return wait_idle_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    bool wait_idle_until(std::chrono::steady_clock::time_point deadline) {
+        check_not_in_pool();
+        while (outstanding_.load(std::memory_order_acquire) != 0) {
+            uint32_t epoch = idle_epoch_.load(std::memory_order_acquire);
+            idle_waiters_.fetch_add(1, std::memory_order_seq_cst);
+            bool in_time = true;
+            if (outstanding_.load(std::memory_order_seq_cst) != 0) {
+                in_time = futex_wait_until(idle_epoch_, epoch, deadline);
+            }
+            idle_waiters_.fetch_sub(1, std::memory_order_relaxed);
+            if (!in_time) {
+                return outstanding_.load(std::memory_order_acquire) == 0;
+            }
+        }
+        return true;
+    }
+
+    // Tasks dropped by CoDel so far.
+    size_t dropped_tasks() const {
+        return dropped_tasks_.load(std::memory_order_relaxed);
+    }
+
+    Metrics metrics() const
+        requires(Config::kMetrics)
+    {
+        return Metrics {
+            metrics_.submitted.load(std::memory_order_relaxed),
+            metrics_.rejected.load(std::memory_order_relaxed),
+            metrics_.completed.load(std::memory_order_relaxed),
+            std::chrono::nanoseconds(
+                metrics_.busy_ns.load(std::memory_order_relaxed))};
+    }
+
+    // Called on the submitting thread or the worker for every event. Set it
+    // before submitting tasks; it is not synchronized with them.
+    void set_trace_callback(TraceCallback callback)
+        requires(Config::kTracing)
+    {
+        trace_callback_ = std::move(callback);
+    }
+
     void shutdown() {
         if (state_.load(std::memory_order_relaxed) != State::Running) {
             return;  // Already shutting down or stopped
         }
+        timer_.shutdown();
         state_.store(State::Stopping, std::memory_order_release);
         wait_strategy_->notify_all();
+        wake_parked(INT_MAX);
+        wake_compensation_workers();
         for (auto &worker : workers_) {
             if (worker.joinable()) {
                 worker.join();
             }
         }
+        {
+            std::scoped_lock<std::mutex> lock(monitor_mtx_);
+            monitor_stop_ = true;
+        }
+        monitor_cv_.notify_all();
+        if (monitor_thread_.joinable()) {
+            monitor_thread_.join();
+        }
+        join_compensation_workers();
         state_.store(State::Stopped, std::memory_order_release);
     }
 
 private:
 
+    // Shared by the claimers of one submit_range() call.
+    template <typename Func>
+    struct RangeState {
+        RangeState(BasicThreadPool *pool,
+                   Meta             metadata,
+                   Func             func,
+                   size_t           count,
+                   size_t           grain) :
+            pool(pool),
+            metadata(std::move(metadata)),
+            func(std::move(func)),
+            count(count),
+            grain(grain) {}
+
+        BasicThreadPool    *pool;
+        Meta                metadata;
+        Func                func;
+        const size_t        count;
+        const size_t        grain;
+        std::atomic<size_t> cursor {0};
+        std::atomic<size_t> finished {0};
+        std::atomic<size_t> claimers {1};  // Queued or running
+        std::atomic<bool>   failed {false};
+        std::exception_ptr  error;  // Set by whoever sets `failed`
+        std::promise<void>  promise;
+    };
+
+    template <typename Func>
+    static void run_range(const std::shared_ptr<RangeState<Func>> &state) {
+        auto &range = *state;
+        range.pool->spread_range(state);
+        size_t begin;
+        while ((begin = range.cursor.fetch_add(range.grain,
+                                               std::memory_order_relaxed)) <
+               range.count) {
+            size_t end = std::min(begin + range.grain, range.count);
+            if (!range.failed.load(std::memory_order_relaxed)) {
+                try {
+                    if constexpr (std::invocable<Func &, size_t, size_t>) {
+                        range.func(begin, end);
+                    } else {
+                        for (size_t i = begin; i < end; ++i) {
+                            range.func(i);
+                        }
+                    }
+                } catch (...) {
+                    if (!range.failed.exchange(true,
+                                               std::memory_order_relaxed)) {
+                        range.error = std::current_exception();
+                    }
+                }
+            }
+            size_t done = end - begin;
+            if (range.finished.fetch_add(done, std::memory_order_acq_rel) +
+                    done ==
+                range.count) {
+                if (range.error) {
+                    range.promise.set_exception(range.error);
+                } else {
+                    range.promise.set_value();
+                }
+            }
+        }
+        range.claimers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Queue one more claimer for a range with chunks left, unless PoolSize
+    // are already queued or running. A full queue just means fewer helpers.
+    template <typename Func>
+    void spread_range(const std::shared_ptr<RangeState<Func>> &state) {
+        auto &range = *state;
+        if (range.cursor.load(std::memory_order_relaxed) + range.grain >=
+            range.count) {
+            return;
+        }
+        if (range.claimers.fetch_add(1, std::memory_order_relaxed) >=
+            PoolSize) {
+            range.claimers.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+        // Helpers skip admission and rate limits, which the range already
+        // passed, but are counted and traced like any other queued task.
+        InternalTask helper {range.metadata, [state] { run_range(state); }};
+        begin_task();
+        trace(TraceEvent::Submitted, helper.metadata, nullptr);
+        track_queued(true);
+        if (task_queue_->enqueue(std::move(helper))) {
+            count(&MetricCounters::submitted);
+            notify_workers();
+        } else {
+            track_queued(false);
+            trace(TraceEvent::Rejected, range.metadata, nullptr);
+            count(&MetricCounters::rejected);
+            finish_task();
+            range.claimers.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
     void launch_all_workers() {
         for (size_t i = 0; i < PoolSize; ++i) {
-            workers_[i] = std::thread(&ThreadPool::worker_thread, this, i);
+            workers_[i] =
+                std::thread(&BasicThreadPool::worker_thread, this, i);
+        }
+    }
+
+    void submit_task(InternalTask &&task, size_t worker = kNoWorker) {
+        if (!offer_task(std::move(task), worker)) {
+            throw std::runtime_error("Failed to enqueue task");
+        }
+    }
+
+    // Returns false if the task was rejected or the queue was full.
+    bool offer_task(InternalTask &&task, size_t worker = kNoWorker) {
+        begin_task();
+        if constexpr (ClassifiedMetadata<Meta> &&
+                      std::copy_constructible<Meta>) {
+            auto task_class = static_cast<size_t>(task.metadata.task_class);
+            if (task_class < kMaxTaskClasses) {
+                auto *bucket =
+                    rate_limiters_[task_class].load(std::memory_order_acquire);
+                if (bucket != nullptr) {
+                    auto delay = bucket->acquire(now_ns());
+                    if (delay.count() > 0) {
+                        trace(TraceEvent::Submitted, task.metadata, nullptr);
+                        if (!defer_task(task, delay, worker)) {
+                            trace(TraceEvent::Rejected, task.metadata, nullptr);
+                            count(&MetricCounters::rejected);
+                            finish_task();
+                            return false;
+                        }
+                        count(&MetricCounters::submitted);
+                        return true;
+                    }
+                }
+            }
+        }
+        auto *admission = admission_.load(std::memory_order_acquire);
+        if (admission != nullptr && !admission->try_acquire()) {
+            trace(TraceEvent::Rejected, task.metadata, nullptr);
+            count(&MetricCounters::rejected);
+            finish_task();
+            return false;
+        }
+        stamp(task, admission);
+        trace(TraceEvent::Submitted, task.metadata, nullptr);
+        if (!enqueue(std::move(task), worker)) {
+            if (admission != nullptr) {
+                admission->abandon();
+            }
+            trace(TraceEvent::Rejected, task.metadata, nullptr);
+            count(&MetricCounters::rejected);
+            finish_task();
+            return false;
+        }
+        count(&MetricCounters::submitted);
+        notify_workers(worker);
+        return true;
+    }
+
+    // Put the task on `worker`'s queue, or on the one its affinity key
+    // hashes to, falling back to the shared queue when there is none or it
+    // is full. `worker` is left naming the queue used, kNoWorker for the
+    // shared one.
+    bool enqueue(InternalTask &&task, size_t &worker) {
+        track_queued(true);
+        if (!push(std::move(task), worker)) {
+            track_queued(false);
+            return false;
+        }
+        return true;
+    }
+
+    bool push(InternalTask &&task, size_t &worker) {
+        if constexpr (kWorkerQueues) {
+            if constexpr (AffinityMetadata<Meta>) {
+                if (worker == kNoWorker) {
+                    worker = home_worker(task.metadata);
+                }
+            }
+            if (worker != kNoWorker &&
+                worker_queues_[worker].queue.enqueue(std::move(task))) {
+                return true;
+            }
+        }
+        worker = kNoWorker;
+        return task_queue_->enqueue(std::move(task));
+    }
+
+    static size_t home_worker(const Meta &metadata)
+        requires AffinityMetadata<Meta>
+    {
+        using Key = std::remove_cvref_t<decltype(metadata.affinity_key)>;
+        return std::hash<Key> {}(metadata.affinity_key) % PoolSize;
+    }
+
+    // Next task for worker `index` (kNoWorker for other threads): its own
+    // queue first, then the shared one, then the other workers' queues.
+    std::optional<InternalTask> take(size_t index) {
+        std::optional<InternalTask> task = pop(index);
+        if (task) {
+            track_queued(false);
+        }
+        return task;
+    }
+
+    std::optional<InternalTask> pop(size_t index) {
+        if constexpr (kWorkerQueues) {
+            if (index != kNoWorker) {
+                if (auto task = worker_queues_[index].queue.try_dequeue()) {
+                    return task;
+                }
+            }
+        }
+        if (auto task = task_queue_->try_dequeue()) {
+            return task;
+        }
+        if constexpr (kWorkerQueues) {
+            size_t start = index == kNoWorker ? 0 : index + 1;
+            for (size_t i = 0; i < PoolSize; ++i) {
+                auto &victim = worker_queues_[(start + i) % PoolSize];
+                if (victim.owner.load(std::memory_order_relaxed) !=
+                    Owner::Busy) {
+                    continue;
+                }
+                if (auto task = victim.queue.try_dequeue()) {
+                    return task;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Only the tiered idle policy needs the queue depth.
+    void track_queued(bool pushed) {
+        if constexpr (kTiered) {
+            if (pushed) {
+                tiers_.queued.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                tiers_.queued.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Every accepted task is counted from submission until run() returns,
+    // however many times it is forwarded or parked in between.
+    void begin_task() {
+        outstanding_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Pairs with wait_idle(): either the waiter sees the count reach zero,
+    // or this sees the waiter and bumps the epoch it sleeps on.
+    void finish_task() {
+        if (outstanding_.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+            idle_waiters_.load(std::memory_order_seq_cst) != 0) {
+            idle_epoch_.fetch_add(1, std::memory_order_release);
+            futex_wake(idle_epoch_, INT_MAX);
+        }
+    }
+
+    WorkerStorage &current_storage() const {
+        if (current_pool_ != this || current_storage_ == nullptr) {
+            throw std::logic_error("Worker storage is only available on "
+                                   "the pool's own workers");
+        }
+        return *current_storage_;
+    }
+
+    // Dense per-type index into WorkerStorage::locals.
+    template <typename T>
+    static size_t local_id() {
+        static const size_t id =
+            next_local_id_.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    void check_not_in_pool() const {
+        if (current_pool_ == this) {
+            throw std::logic_error("Cannot wait for the pool to idle from "
+                                   "one of its own tasks");
+        }
+    }
+
+    void count(std::atomic<size_t> MetricCounters::*counter) {
+        if constexpr (Config::kMetrics) {
+            (metrics_.*counter).fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void trace(TraceEvent event, const Meta &metadata, const WorkerSlot *slot) {
+        if constexpr (Config::kTracing) {
+            if (trace_callback_) {
+                size_t worker = slot == nullptr
+                                    ? kNoWorker
+                                    : static_cast<size_t>(slot - slots_.data());
+                trace_callback_(
+                    TraceRecord {event, metadata, worker, now_ns()});
+            }
+        }
+    }
+
+    // Timestamp a task about to be queued if its wait will be measured.
+    // With admission control every stamped task holds a slot, released in
+    // run() once the task is done.
+    void stamp(InternalTask &task, AdmissionController *admission) {
+        if (admission != nullptr ||
+            codel_.load(std::memory_order_acquire) != nullptr) {
+            task.enqueued_ns = now_ns();
+        }
+    }
+
+    // `worker` names the worker queue the task went to, if any: its owner
+    // is left to take it unless busy, when anyone may steal it.
+    void notify_workers(size_t worker = kNoWorker) {
+        if constexpr (kWorkerQueues) {
+            if (worker != kNoWorker && notify_owner(worker_queues_[worker])) {
+                return;
+            }
+        }
+        if constexpr (kTiered) {
+            promote();
+        } else if constexpr (kWorkerQueues) {
+            wake_parked(1);
+        } else {
+            wait_strategy_->notify();
+        }
+        if (compensation_workers_.load(std::memory_order_relaxed) != 0) {
+            compensation_signal_.fetch_add(1, std::memory_order_release);
+            futex_wake(compensation_signal_, 1);
+        }
+    }
+
+    // Pairs with park(): either the owner's re-check finds the task or this
+    // sees it parked and wakes it. Returns false if the owner is busy.
+    bool notify_owner(WorkerQueue &queue) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        Owner owner = queue.owner.load(std::memory_order_relaxed);
+        while (owner == Owner::Parked &&
+               !queue.owner.compare_exchange_weak(owner,
+                                                  Owner::Idle,
+                                                  std::memory_order_seq_cst)) {
+        }
+        if (owner == Owner::Busy) {
+            return false;
+        }
+        if (owner == Owner::Parked) {
+            queue.wake.fetch_add(1, std::memory_order_release);
+            futex_wake(queue.wake, 1);
+        }
+        return true;
+    }
+
+    // Hand `task` to the timer thread, to be queued for `worker` as
+    // submitted. Returns false, with `task` intact, if the timer has
+    // already shut down.
+    bool defer_task(InternalTask            &task,
+                    std::chrono::nanoseconds delay,
+                    size_t                   worker = kNoWorker) {
+        auto deferred = std::make_shared<InternalTask>(std::move(task));
+        try {
+            timer_.schedule_after(delay, [this, deferred, worker] {
+                enqueue_deferred(deferred, worker);
+            });
+            return true;
+        } catch (const std::runtime_error &) {
+            task = std::move(*deferred);
+            return false;
         }
     }
 
+    // Runs on the timer thread. The queue only gets a forwarding copy, so a
+    // full queue leaves the task intact for a retry.
+    void enqueue_deferred(const std::shared_ptr<InternalTask> &deferred,
+                          size_t                               worker) {
+        auto  *admission = admission_.load(std::memory_order_acquire);
+        size_t queued    = worker;
+        while (true) {
+            if (admission != nullptr) {
+                admission->acquire();
+            }
+            InternalTask forward {deferred->metadata, [deferred] {
+                deferred->data();
+            }};
+            stamp(forward, admission);
+            queued = worker;
+            if (enqueue(std::move(forward), queued)) {
+                break;
+            }
+            if (admission != nullptr) {
+                admission->abandon();
+            }
+            try {
+                timer_.schedule_after(std::chrono::milliseconds(1),
+                                      [this, deferred, worker] {
+                    enqueue_deferred(deferred, worker);
+                });
+                return;
+            } catch (const std::runtime_error &) {
+                std::this_thread::yield();  // Flushing at shutdown
+            }
+        }
+        notify_workers(queued);
+    }
+
     void worker_thread(size_t index) {
         auto &strategy = *wait_strategy_;
+        auto &slot     = slots_[index];
+        WorkerStorage storage(Config::kArenaBlockSize);
+        current_pool_    = this;
+        current_slot_    = &slot;
+        current_storage_ = &storage;
+        Config::Affinity::on_worker_start(index);
+        if (worker_init_) {
+            worker_init_(*this, index);
+        }
         while (true) {
-            InternalTask task;
-            if (task_queue_->dequeue(task)) {
-                strategy.reset();
-                active_tasks_.fetch_add(1, std::memory_order_acq_rel);
-                task.data();
-                active_tasks_.fetch_sub(1, std::memory_order_acq_rel);
-            } else if (state_.load(std::memory_order_relaxed) ==
-                           State::Stopping &&
-                       active_tasks_.load(std::memory_order_relaxed) == 0) {
+            std::optional<InternalTask> task = take(index);
+            if (!task && state_.load(std::memory_order_relaxed) ==
+                             State::Stopping) {
+                // A sibling may have reset the strategy after shutdown's
+                // broadcast and gone back to sleep; pass the wakeup on.
+                strategy.notify_all();
                 break;
+            }
+            if (!task) {
+                idle_workers_.fetch_add(1, std::memory_order_seq_cst);
+                if constexpr (kTiered) {
+                    task = idle(index);
+                } else if constexpr (kWorkerQueues) {
+                    task = park(index);
+                } else {
+                    strategy.wait();
+                }
+                leave_idle();
+            }
+            if (task) {
+                if constexpr (!kTiered && !kWorkerQueues) {
+                    strategy.reset();
+                }
+                execute(*task, &slot);
+                storage.arena.reset();
+            }
+        }
+    }
+
+    // Idle as a hot worker if a hot slot is free, else park. Returns a task
+    // found meanwhile, or nullopt to re-check the queues and pool state.
+    std::optional<InternalTask> idle(size_t index) {
+        auto  &tiers = tiers_;
+        size_t hot   = tiers.spinning.load(std::memory_order_relaxed);
+        while (hot < Config::kHotWorkers) {
+            if (!tiers.spinning.compare_exchange_weak(
+                    hot,
+                    hot + 1,
+                    std::memory_order_seq_cst)) {
+                continue;
+            }
+            std::optional<InternalTask> task = spin(index);
+            tiers.spinning.fetch_sub(1, std::memory_order_seq_cst);
+            if (task ||
+                state_.load(std::memory_order_relaxed) != State::Running) {
+                return task;
+            }
+            break;  // Idle for kHotIdleTimeout: demote
+        }
+        return park(index);
+    }
+
+    std::optional<InternalTask> spin(size_t index) {
+        constexpr std::chrono::nanoseconds kTimeout = Config::kHotIdleTimeout;
+        int64_t deadline = now_ns() + kTimeout.count();
+        for (size_t round = 1;; ++round) {
+            if (std::optional<InternalTask> task = take(index)) {
+                return task;
+            }
+            if (state_.load(std::memory_order_relaxed) != State::Running) {
+                return std::nullopt;
+            }
+            if (round % 64 == 0 && now_ns() >= deadline) {
+                return std::nullopt;
+            }
+            cpu_relax();
+        }
+    }
+
+    // Pairs with promote() and notify_owner(): either the re-check finds
+    // the task or the submitter sees this worker parked and bumps the word
+    // it sleeps on. With worker queues that is the worker's own, so a task
+    // routed to it wakes it rather than a sibling.
+    std::optional<InternalTask> park(size_t index) {
+        std::atomic<uint32_t> *word;
+        if constexpr (kWorkerQueues) {
+            word = &worker_queues_[index].wake;
+        } else {
+            word = &tiers_.epoch;
+        }
+        uint32_t seen = word->load(std::memory_order_acquire);
+        if constexpr (kTiered) {
+            tiers_.parked.fetch_add(1, std::memory_order_relaxed);
+        }
+        if constexpr (kWorkerQueues) {
+            worker_queues_[index].owner.store(Owner::Parked,
+                                              std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::optional<InternalTask> task = take(index);
+        if (!task &&
+            state_.load(std::memory_order_acquire) == State::Running) {
+            futex_wait(*word, seen);
+        }
+        if constexpr (kTiered) {
+            tiers_.parked.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    // Wake a parked worker when no hot worker is free to take the new task,
+    // or when queued tasks outnumber the hot workers awake to take them.
+    // Tasks waiting on the timer or a concurrency limit are not queued yet
+    // and do not count.
+    void promote() {
+        auto &tiers = tiers_;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        size_t parked = tiers.parked.load(std::memory_order_relaxed);
+        if (parked == 0) {
+            return;
+        }
+        size_t spinning = tiers.spinning.load(std::memory_order_relaxed);
+        if (spinning == 0 ||
+            tiers.queued.load(std::memory_order_relaxed) > spinning) {
+            wake_parked(1);
+        }
+    }
+
+    void wake_parked(int count) {
+        if constexpr (kWorkerQueues) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            for (auto &queue : worker_queues_) {
+                if (count == 0) {
+                    break;
+                }
+                Owner parked = Owner::Parked;
+                if (queue.owner.compare_exchange_strong(
+                        parked, Owner::Idle, std::memory_order_seq_cst)) {
+                    queue.wake.fetch_add(1, std::memory_order_release);
+                    futex_wake(queue.wake, 1);
+                    --count;
+                }
+            }
+        } else if constexpr (kTiered) {
+            tiers_.epoch.fetch_add(1, std::memory_order_release);
+            futex_wake(tiers_.epoch, count);
+        }
+    }
+
+    // Run a dequeued task; `slot` is null outside the fixed workers.
+    void execute(InternalTask &task, WorkerSlot *slot) {
+        if constexpr (ClassifiedMetadata<Meta>) {
+            auto *limiter = class_limiter(task.metadata);
+            if (limiter != nullptr) {
+                if (!limiter->admit(task)) {
+                    return;
+                }
+                do {
+                    run(task, slot);
+                } while (limiter->release(task));
+                return;
+            }
+        }
+        run(task, slot);
+    }
+
+    void run(InternalTask &task, WorkerSlot *slot) {
+        mark_owner(slot, Owner::Busy);
+        if (task.enqueued_ns == 0) {
+            dispatch(task, slot);
+            mark_owner(slot, Owner::Idle);
+            finish_task();
+            return;
+        }
+        int64_t                  started = now_ns();
+        std::chrono::nanoseconds waited(started - task.enqueued_ns);
+
+        auto *codel = codel_.load(std::memory_order_acquire);
+        if (codel != nullptr && codel->should_drop(started, waited)) {
+            dropped_tasks_.fetch_add(1, std::memory_order_relaxed);
+            trace(TraceEvent::Dropped, task.metadata, slot);
+            task.data = nullptr;  // Breaks the task's promise
+        } else {
+            dispatch(task, slot);
+        }
+        auto *admission = admission_.load(std::memory_order_acquire);
+        if (admission != nullptr) {
+            admission->release(waited);
+        }
+        mark_owner(slot, Owner::Idle);
+        finish_task();
+    }
+
+    // Others may steal from a fixed worker's queue only while it runs a
+    // task. It goes back to idle before the task is counted done, so after
+    // wait_idle() no owner is left marked busy, and before its next take(),
+    // so a task routed to it is either found there or sees it idle.
+    void mark_owner(const WorkerSlot *slot, Owner owner) {
+        if constexpr (kWorkerQueues) {
+            if (slot != nullptr) {
+                worker_queues_[static_cast<size_t>(slot - slots_.data())]
+                    .owner.store(owner,
+                                 owner == Owner::Busy
+                                     ? std::memory_order_relaxed
+                                     : std::memory_order_seq_cst);
+            }
+        }
+    }
+
+    void dispatch(InternalTask &task, WorkerSlot *slot) {
+        if (slot != nullptr && monitoring_.load(std::memory_order_relaxed)) {
+            run_monitored(*slot, task);
+        } else {
+            invoke(task, slot);
+        }
+    }
+
+    void invoke(InternalTask &task, WorkerSlot *slot) {
+        trace(TraceEvent::Started, task.metadata, slot);
+        if constexpr (Config::kMetrics) {
+            int64_t started = now_ns();
+            task.data();
+            metrics_.busy_ns.fetch_add(now_ns() - started,
+                                       std::memory_order_relaxed);
+            metrics_.completed.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            task.data();
+        }
+        trace(TraceEvent::Finished, task.metadata, slot);
+    }
+
+    void run_monitored(WorkerSlot &slot, InternalTask &task) {
+        slot.task_started_ns.store(now_ns(), std::memory_order_relaxed);
+        slot.metadata.store(&task.metadata, std::memory_order_release);
+        invoke(task, &slot);
+        slot.metadata.store(nullptr, std::memory_order_seq_cst);
+        slot.task_started_ns.store(0, std::memory_order_seq_cst);
+        // Keep the metadata alive while the watchdog is reporting it.
+        while (slot.readers.load(std::memory_order_seq_cst) != 0) {
+            std::this_thread::yield();
+        }
+        if (slot.presumed_blocked.exchange(false, std::memory_order_seq_cst)) {
+            remove_blocked();
+        }
+    }
+
+    ConcurrencyLimiter<InternalTask> *class_limiter(const Meta &metadata) {
+        auto task_class = static_cast<size_t>(metadata.task_class);
+        if (task_class >= kMaxTaskClasses) {
+            return nullptr;
+        }
+        return class_limiters_[task_class].load(std::memory_order_acquire);
+    }
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void enter_blocking() {
+        if (current_slot_ != nullptr) {
+            current_slot_->in_region.store(true, std::memory_order_relaxed);
+            // The monitor already counted this worker; take over its claim.
+            if (current_slot_->presumed_blocked.exchange(
+                    false,
+                    std::memory_order_seq_cst)) {
+                return;
+            }
+        }
+        add_blocked();
+    }
+
+    void leave_blocking_region() {
+        if (--region_depth_ != 0) {
+            return;
+        }
+        if (current_slot_ != nullptr) {
+            current_slot_->in_region.store(false, std::memory_order_relaxed);
+        }
+        remove_blocked();
+    }
+
+    void add_blocked() {
+        size_t blocked =
+            blocked_workers_.fetch_add(1, std::memory_order_seq_cst) + 1;
+        spawn_compensation_worker(blocked);
+    }
+
+    // While a fixed worker idles, spawn_compensation_worker() leaves blocked
+    // workers uncovered; the last one to get busy again makes up for it.
+    void leave_idle() {
+        if (idle_workers_.fetch_sub(1, std::memory_order_seq_cst) != 1) {
+            return;
+        }
+        size_t blocked = blocked_workers_.load(std::memory_order_seq_cst);
+        if (blocked > compensation_workers_.load(std::memory_order_acquire)) {
+            spawn_compensation_worker(blocked);
+        }
+    }
+
+    void remove_blocked() {
+        size_t blocked =
+            blocked_workers_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+        if (compensation_workers_.load(std::memory_order_acquire) > blocked) {
+            wake_compensation_workers();
+        }
+    }
+
+    void spawn_compensation_worker(size_t blocked) {
+        // Pairs with leave_idle(): either we see the idle worker and skip,
+        // or it sees the blocked count and spawns on its way out of idle.
+        // A skip also wakes an idle worker: a wait strategy may have lost
+        // its wakeup to a sibling's reset(), and with this worker blocked
+        // nobody else would come back for the queued tasks.
+        if (idle_workers_.load(std::memory_order_seq_cst) != 0) {
+            if constexpr (kTiered || kWorkerQueues) {
+                wake_parked(1);
             } else {
-                strategy.wait();
+                wait_strategy_->notify();
+            }
+            return;
+        }
+        size_t live = compensation_workers_.load(std::memory_order_acquire);
+        while (live < blocked && live < kMaxCompensationWorkers) {
+            if (!compensation_workers_.compare_exchange_weak(
+                    live,
+                    live + 1,
+                    std::memory_order_acq_rel)) {
+                continue;
+            }
+            if (reuse_compensation_worker()) {
+                return;
+            }
+            std::list<CompensationWorker> finished;
+            {
+                std::scoped_lock<std::mutex> lock(compensation_mtx_);
+                if (compensation_closed_) {
+                    compensation_workers_.fetch_sub(1,
+                                                    std::memory_order_acq_rel);
+                    return;
+                }
+                for (auto it = compensation_threads_.begin();
+                     it != compensation_threads_.end();) {
+                    auto next = std::next(it);
+                    if (it->finished.load(std::memory_order_acquire)) {
+                        finished.splice(finished.end(),
+                                        compensation_threads_,
+                                        it);
+                    }
+                    it = next;
+                }
+                auto &worker  = compensation_threads_.emplace_back();
+                worker.thread =
+                    std::thread(&BasicThreadPool::compensation_thread,
+                                this,
+                                &worker);
+            }
+            // These threads have already returned, so joining is quick.
+            for (auto &worker : finished) {
+                worker.thread.join();
             }
+            return;
         }
     }
 
+    // Hand an activation to a lingering compensation thread, if any.
+    bool reuse_compensation_worker() {
+        size_t lingering =
+            compensation_lingering_.load(std::memory_order_acquire);
+        while (lingering != 0) {
+            if (compensation_lingering_.compare_exchange_weak(
+                    lingering,
+                    lingering - 1,
+                    std::memory_order_acq_rel)) {
+                compensation_claims_.fetch_add(1, std::memory_order_release);
+                wake_compensation_workers();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void compensation_thread(CompensationWorker *self) {
+        WorkerStorage storage(Config::kArenaBlockSize);
+        current_pool_    = this;
+        current_storage_ = &storage;
+        if (worker_init_) {
+            worker_init_(*this, kNoWorker);
+        }
+        while (true) {
+            uint32_t seen =
+                compensation_signal_.load(std::memory_order_acquire);
+            size_t live = compensation_workers_.load(std::memory_order_acquire);
+            if (live > blocked_workers_.load(std::memory_order_acquire)) {
+                if (!compensation_workers_.compare_exchange_weak(
+                        live,
+                        live - 1,
+                        std::memory_order_acq_rel)) {
+                    continue;
+                }
+                if (linger()) {
+                    continue;
+                }
+                break;
+            }
+            if (std::optional<InternalTask> task = take(kNoWorker)) {
+                execute(*task, nullptr);
+                storage.arena.reset();
+                continue;
+            }
+            if (state_.load(std::memory_order_acquire) != State::Running) {
+                compensation_workers_.fetch_sub(1, std::memory_order_acq_rel);
+                break;
+            }
+            futex_wait(compensation_signal_, seen);
+        }
+        self->finished.store(true, std::memory_order_release);
+    }
+
+    // Park a retired compensation thread until reuse_compensation_worker()
+    // claims it (returns true) or kCompensationLinger passes or the pool
+    // stops (returns false). A thread only leaves by taking itself off the
+    // lingering count, so a claim always finds someone to pick it up.
+    bool linger() {
+        compensation_lingering_.fetch_add(1, std::memory_order_acq_rel);
+        auto deadline = std::chrono::steady_clock::now() + kCompensationLinger;
+        bool expired  = false;
+        while (true) {
+            uint32_t seen =
+                compensation_signal_.load(std::memory_order_acquire);
+            size_t claims =
+                compensation_claims_.load(std::memory_order_acquire);
+            if (claims != 0) {
+                if (compensation_claims_.compare_exchange_weak(
+                        claims,
+                        claims - 1,
+                        std::memory_order_acq_rel)) {
+                    return true;
+                }
+                continue;
+            }
+            if (expired ||
+                state_.load(std::memory_order_acquire) != State::Running) {
+                size_t lingering =
+                    compensation_lingering_.load(std::memory_order_acquire);
+                if (lingering != 0) {
+                    if (compensation_lingering_.compare_exchange_weak(
+                            lingering,
+                            lingering - 1,
+                            std::memory_order_acq_rel)) {
+                        return false;
+                    }
+                    continue;
+                }
+                // Every lingering thread is spoken for; a claim and its
+                // wakeup are on the way.
+                futex_wait(compensation_signal_, seen);
+                continue;
+            }
+            expired = !futex_wait_until(compensation_signal_, seen, deadline);
+        }
+    }
+
+    void wake_compensation_workers() {
+        compensation_signal_.fetch_add(1, std::memory_order_release);
+        futex_wake(compensation_signal_, INT_MAX);
+    }
+
+    void join_compensation_workers() {
+        while (true) {
+            std::list<CompensationWorker> workers;
+            {
+                std::scoped_lock<std::mutex> lock(compensation_mtx_);
+                if (compensation_threads_.empty()) {
+                    compensation_closed_ = true;
+                    return;
+                }
+                workers.splice(workers.end(), compensation_threads_);
+            }
+            for (auto &worker : workers) {
+                worker.thread.join();
+            }
+        }
+    }
+
+    // Requires monitor_mtx_.
+    void start_monitor() {
+        monitoring_.store(true, std::memory_order_release);
+        if (!monitor_thread_.joinable() && !monitor_stop_) {
+            monitor_thread_ =
+                std::thread(&BasicThreadPool::monitor_thread, this);
+        }
+        monitor_cv_.notify_all();
+    }
+
+    void monitor_thread() {
+        std::array<int64_t, PoolSize> reported {};
+        std::unique_lock<std::mutex>  lock(monitor_mtx_);
+        while (!monitor_stop_) {
+            auto blocking_threshold = blocking_threshold_;
+            auto watchdog_threshold = watchdog_threshold_;
+            auto callback           = watchdog_callback_;
+            auto shortest           = blocking_threshold;
+            if (shortest.count() == 0 ||
+                (watchdog_threshold.count() != 0 &&
+                 watchdog_threshold < shortest)) {
+                shortest = watchdog_threshold;
+            }
+            auto interval = std::max<std::chrono::nanoseconds>(
+                shortest / 4,
+                std::chrono::milliseconds(1));
+            monitor_cv_.wait_for(lock, interval, [this] {
+                return monitor_stop_;
+            });
+            if (monitor_stop_) {
+                break;
+            }
+            lock.unlock();
+            int64_t now = now_ns();
+            for (size_t i = 0; i < PoolSize; ++i) {
+                auto   &slot    = slots_[i];
+                int64_t started = slot.task_started_ns.load(
+                    std::memory_order_acquire);
+                if (started == 0) {
+                    continue;
+                }
+                std::chrono::nanoseconds elapsed(now - started);
+                if (callback && watchdog_threshold.count() != 0 &&
+                    elapsed >= watchdog_threshold && reported[i] != started) {
+                    reported[i] = started;
+                    report_stuck_task(i, started, elapsed, callback);
+                }
+                if (blocking_threshold.count() != 0 &&
+                    elapsed >= blocking_threshold) {
+                    presume_blocked(slot, started);
+                }
+            }
+            lock.lock();
+        }
+    }
+
+    void report_stuck_task(size_t                   index,
+                           int64_t                  started,
+                           std::chrono::nanoseconds elapsed,
+                           const WatchdogCallback  &callback) {
+        auto &slot = slots_[index];
+        slot.readers.fetch_add(1, std::memory_order_seq_cst);
+        // Load the metadata before re-checking the stamp: a newer task
+        // publishes its stamp first, so a match means the pointer is ours.
+        const Meta *metadata = slot.metadata.load(std::memory_order_seq_cst);
+        if (metadata != nullptr &&
+            slot.task_started_ns.load(std::memory_order_seq_cst) == started) {
+            callback(StuckTask {index, *metadata, elapsed});
+        }
+        slot.readers.fetch_sub(1, std::memory_order_release);
+    }
+
+    void presume_blocked(WorkerSlot &slot, int64_t started) {
+        if (slot.in_region.load(std::memory_order_relaxed) ||
+            slot.presumed_blocked.load(std::memory_order_relaxed)) {
+            return;
+        }
+        blocked_workers_.fetch_add(1, std::memory_order_seq_cst);
+        slot.presumed_blocked.store(true, std::memory_order_seq_cst);
+        // The task may have finished meanwhile; whoever clears the flag
+        // first owns the decrement.
+        if (slot.task_started_ns.load(std::memory_order_seq_cst) != started) {
+            if (slot.presumed_blocked.exchange(false,
+                                               std::memory_order_seq_cst)) {
+                remove_blocked();
+            }
+            return;
+        }
+        spawn_compensation_worker(
+            blocked_workers_.load(std::memory_order_acquire));
+    }
+
     enum class State {
         Initializing,
         Running,
@@ -139,13 +1706,71 @@ private:
         Stopped
     };
 
-    std::shared_ptr<MPMCQueue<InternalTask>> task_queue_;
-    std::array<std::thread, PoolSize>        workers_;
-    std::atomic<State>                       state_;
-    std::atomic<size_t>                      active_tasks_;
-    std::shared_ptr<WaitStrategy>            wait_strategy_;
+    std::shared_ptr<TaskQueue>        task_queue_;
+    std::array<std::thread, PoolSize> workers_;
+    std::atomic<State>                state_;
+    std::shared_ptr<WaitStrategy>     wait_strategy_;
+    WorkerInit                        worker_init_;
+
+    std::array<WorkerSlot, PoolSize> slots_;
+    [[no_unique_address]] std::conditional_t<kTiered, Tiers, Disabled> tiers_;
+    [[no_unique_address]] std::conditional_t<kWorkerQueues,
+                                             std::array<WorkerQueue, PoolSize>,
+                                             Disabled> worker_queues_;
+    alignas(64) std::atomic<size_t> blocked_workers_;
+    std::atomic<size_t>             compensation_workers_;
+    std::atomic<size_t>             compensation_lingering_;
+    std::atomic<size_t>             compensation_claims_;
+    std::atomic<uint32_t>           compensation_signal_;
+    std::atomic<size_t>             idle_workers_;
+    std::atomic<bool>               monitoring_;
+    std::mutex                      compensation_mtx_;
+    std::list<CompensationWorker>   compensation_threads_;
+    bool                            compensation_closed_ = false;
+    std::mutex                      monitor_mtx_;
+    std::condition_variable         monitor_cv_;
+    std::thread                     monitor_thread_;
+    std::chrono::nanoseconds        blocking_threshold_ {0};
+    std::chrono::nanoseconds        watchdog_threshold_ {0};
+    WatchdogCallback                watchdog_callback_;
+    bool                            monitor_stop_ = false;
+
+    std::array<std::atomic<ConcurrencyLimiter<InternalTask> *>, kMaxTaskClasses>
+        class_limiters_ {};
+
+    std::array<std::atomic<TokenBucket *>, kMaxTaskClasses> rate_limiters_ {};
+    TimerQueue                                              timer_;
+
+    std::atomic<AdmissionController *> admission_ {nullptr};
+    std::atomic<Codel *>               codel_ {nullptr};
+    std::atomic<size_t>                dropped_tasks_ {0};
+
+    alignas(64) std::atomic<size_t> outstanding_ {0};
+    std::atomic<uint32_t>           idle_epoch_ {0};
+    std::atomic<uint32_t>           idle_waiters_ {0};
+
+    // Compile to empty members when the feature is off.
+    [[no_unique_address]] std::conditional_t<Config::kMetrics,
+                                             MetricCounters,
+                                             Disabled> metrics_;
+    [[no_unique_address]] std::conditional_t<Config::kTracing,
+                                             TraceCallback,
+                                             Disabled> trace_callback_;
+
+    static inline LC_THREAD_LOCAL BasicThreadPool *current_pool_ = nullptr;
+    static inline LC_THREAD_LOCAL WorkerSlot      *current_slot_ = nullptr;
+    static inline LC_THREAD_LOCAL size_t           region_depth_ = 0;
+    static inline LC_THREAD_LOCAL WorkerStorage   *current_storage_ = nullptr;
+    static inline std::atomic<size_t>              next_local_id_ {0};
 };
 
+// The pool with default policies apart from the wait strategy and queue.
+template <size_t PoolSize, typename Meta = EmptyMetadata,
+          typename WaitStrategy                     = AtomicWaitStrategy,
+          template <typename> class TaskQueueFamily = MPMCQueue>
+using ThreadPool =
+    BasicThreadPool<PoolSize, Meta, PoolConfig<WaitStrategy, TaskQueueFamily>>;
+
 LC_NAMESPACE_END
 
 #endif  // LC_THREAD_POOL_H
@@ -0,0 +1,136 @@
+#ifndef LC_TIMER_QUEUE_H
+#define LC_TIMER_QUEUE_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "lc_config.h"
+
+LC_NAMESPACE_BEGIN
+
+// Runs callbacks at or after their deadline on one lazily started thread.
+// Callbacks should be short (typically an enqueue into a pool); anything
+// heavier belongs on the pool itself.
+class TimerQueue {
+public:
+    using Clock     = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    TimerQueue() = default;
+
+    ~TimerQueue() {
+        shutdown();
+    }
+
+    TimerQueue(const TimerQueue &)            = delete;
+    TimerQueue &operator=(const TimerQueue &) = delete;
+
+    void schedule_at(TimePoint deadline, std::function<void()> callback) {
+        std::scoped_lock<std::mutex> lock(mtx_);
+        if (stopped_) {
+            throw std::runtime_error("Timer queue is shut down");
+        }
+        if (!thread_.joinable()) {
+            thread_ = std::thread(&TimerQueue::run, this);
+        }
+        entries_.push_back(
+            Entry {deadline, next_sequence_++, std::move(callback)});
+        std::push_heap(entries_.begin(), entries_.end(), Later {});
+        cv_.notify_one();
+    }
+
+    void schedule_after(std::chrono::nanoseconds delay,
+                        std::function<void()>    callback) {
+        schedule_at(Clock::now() + delay, std::move(callback));
+    }
+
+    // Stop the timer thread, then run every pending callback immediately in
+    // deadline order on the calling thread.
+    void shutdown() {
+        std::vector<Entry> pending;
+        {
+            std::scoped_lock<std::mutex> lock(mtx_);
+            if (stopped_) {
+                return;
+            }
+            stopped_ = true;
+            pending.swap(entries_);
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        std::sort(pending.begin(), pending.end(), [](auto &a, auto &b) {
+            return Later {}(b, a);
+        });
+        for (auto &entry : pending) {
+            entry.callback();
+        }
+    }
+
+    bool stopped() const {
+        std::scoped_lock<std::mutex> lock(mtx_);
+        return stopped_;
+    }
+
+    std::size_t pending() const {
+        std::scoped_lock<std::mutex> lock(mtx_);
+        return entries_.size();
+    }
+
+private:
+    struct Entry {
+        TimePoint             deadline;
+        uint64_t              sequence;
+        std::function<void()> callback;
+    };
+
+    // Heap order: earliest deadline on top, FIFO among equal deadlines.
+    struct Later {
+        bool operator()(const Entry &a, const Entry &b) const {
+            return a.deadline > b.deadline ||
+                   (a.deadline == b.deadline && a.sequence > b.sequence);
+        }
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (!stopped_) {
+            if (entries_.empty()) {
+                cv_.wait(lock);
+                continue;
+            }
+            TimePoint deadline = entries_.front().deadline;
+            if (Clock::now() < deadline) {
+                cv_.wait_until(lock, deadline);
+                continue;
+            }
+            std::pop_heap(entries_.begin(), entries_.end(), Later {});
+            auto callback = std::move(entries_.back().callback);
+            entries_.pop_back();
+            lock.unlock();
+            callback();
+            lock.lock();
+        }
+    }
+
+    mutable std::mutex      mtx_;
+    std::condition_variable cv_;
+    std::vector<Entry>      entries_;
+    uint64_t                next_sequence_ = 0;
+    bool                    stopped_       = false;
+    std::thread             thread_;
+};
+
+LC_NAMESPACE_END
+
+#endif  // LC_TIMER_QUEUE_H
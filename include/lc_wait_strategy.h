@@ -13,6 +13,22 @@
 #include <thread>
 
 #include "lc_config.h"
+#include "lc_futex.h"
+
+#if defined(LC_PLATFORM_LINUX)
+#  include <poll.h>
+#  include <sys/eventfd.h>
+#  include <unistd.h>
+
+#  include <cerrno>
+#  include <climits>
+#  include <limits>
+#  include <system_error>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  include <immintrin.h>
+#endif
 
 LC_NAMESPACE_BEGIN
 
@@ -135,6 +151,120 @@ private:
     bool                    notified_;
 };
 
+#if defined(LC_PLATFORM_LINUX)
+
+// Idle workers park on a futex-backed token count; notify() grants at most
+// one token per idle worker and wakes exactly one of them, so a submit never
+// stampedes the whole pool. When no worker is idle the notification goes to
+// an eventfd instead, exposed through native_handle(): an external epoll
+// loop can watch it and pull work with try_wait() + ThreadPool::run_one() on
+// its own thread. The descriptor holds at most one pending signal, so a
+// burst of submits costs one write() and leaves no backlog behind.
+class EventFdWaitStrategy : public WaitStrategyBase {
+public:
+    EventFdWaitStrategy() {
+        fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (fd_ < 0) {
+            throw std::system_error(errno,
+                                    std::generic_category(),
+                                    "eventfd failed");
+        }
+    }
+
+    ~EventFdWaitStrategy() override {
+        ::close(fd_);
+    }
+
+    EventFdWaitStrategy(const EventFdWaitStrategy &)            = delete;
+    EventFdWaitStrategy &operator=(const EventFdWaitStrategy &) = delete;
+
+    void wait() override {
+        // Announce ourselves before looking for a token; notify() reads
+        // idle_ after its own fence, so one of the two sides sees the other.
+        idle_.fetch_add(1, std::memory_order_seq_cst);
+        uint32_t tokens = tokens_.load(std::memory_order_seq_cst);
+        while (true) {
+            if (tokens == 0) {
+                futex_wait(tokens_, 0);
+                tokens = tokens_.load(std::memory_order_acquire);
+            } else if (tokens_.compare_exchange_weak(
+                           tokens,
+                           tokens - 1,
+                           std::memory_order_acquire,
+                           std::memory_order_acquire)) {
+                break;
+            }
+        }
+        idle_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Consume the pending descriptor signal without blocking.
+    bool try_wait() {
+        // Disarm before draining: a notify() racing with us re-arms and
+        // writes again, so the descriptor stays readable for it.
+        armed_.store(false, std::memory_order_seq_cst);
+        uint64_t value;
+        return ::read(fd_, &value, sizeof(value)) == sizeof(value);
+    }
+
+    void notify() override {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint32_t idle   = idle_.load(std::memory_order_relaxed);
+        uint32_t tokens = tokens_.load(std::memory_order_relaxed);
+        // Without an idle worker one sticky token covers the worker that is
+        // about to wait; granting more would only make later waits spin.
+        uint32_t limit  = idle > 0 ? idle : 1;
+        while (tokens < limit) {
+            if (tokens_.compare_exchange_weak(tokens,
+                                              tokens + 1,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+                if (idle > 0) {
+                    futex_wake(tokens_, 1);
+                    return;
+                }
+                break;
+            }
+        }
+        if (idle == 0) {
+            arm();
+        }
+    }
+
+    // Leaves a token for (practically) every later wait.
+    void notify_all() override {
+        tokens_.store(kReleased, std::memory_order_release);
+        futex_wake(tokens_, INT_MAX);
+        arm();
+    }
+
+    void reset() override {}
+
+    // Readable while a notification found no idle worker and has not been
+    // consumed by try_wait().
+    int native_handle() const {
+        return fd_;
+    }
+
+private:
+    static constexpr uint32_t kReleased =
+        std::numeric_limits<uint32_t>::max() / 2;
+
+    void arm() {
+        if (!armed_.exchange(true, std::memory_order_seq_cst)) {
+            uint64_t one = 1;
+            LC_MAYBE_UNUSED ssize_t n = ::write(fd_, &one, sizeof(one));
+        }
+    }
+
+    int fd_;
+    alignas(64) std::atomic<uint32_t> tokens_ {0};
+    std::atomic<uint32_t>             idle_ {0};
+    std::atomic<bool>                 armed_ {false};
+};
+
+#endif  // defined(LC_PLATFORM_LINUX)
+
 LC_NAMESPACE_END
 
 #endif  // LC_WAIT_STRATEGY_H
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "lc_blocking_mpmc_queue.h"
+
+using namespace std::chrono_literals;
+using namespace lc;
+
+TEST(BlockingMPMCQueueTest, PopBlocksUntilPush) {
+    BlockingMPMCQueue<int> queue(4);
+    std::atomic<int>       received {-1};
+    std::thread            consumer([&] {
+        int value;
+        EXPECT_TRUE(queue.pop(value));
+        received.store(value);
+    });
+
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(received.load(), -1);
+    EXPECT_TRUE(queue.push(7));
+    consumer.join();
+    EXPECT_EQ(received.load(), 7);
+}
+
+TEST(BlockingMPMCQueueTest, PushBlocksWhileFull) {
+    BlockingMPMCQueue<int> queue(2);
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+
+    std::atomic<bool> pushed {false};
+    std::thread       producer([&] {
+        EXPECT_TRUE(queue.push(3));
+        pushed.store(true);
+    });
+
+    std::this_thread::sleep_for(20ms);
+    EXPECT_FALSE(pushed.load());
+    int value;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 1);
+    producer.join();
+    EXPECT_TRUE(pushed.load());
+    EXPECT_EQ(queue.size(), 2u);
+}
+
+TEST(BlockingMPMCQueueTest, TimedOperationsTimeOut) {
+    BlockingMPMCQueue<std::unique_ptr<int>> queue(2);
+    std::unique_ptr<int>                    out;
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(queue.try_pop_for(out, 20ms));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+
+    EXPECT_TRUE(queue.push(std::make_unique<int>(1)));
+    EXPECT_TRUE(queue.push(std::make_unique<int>(2)));
+    auto value = std::make_unique<int>(3);
+    EXPECT_FALSE(queue.push_for(std::move(value), 20ms));
+    ASSERT_TRUE(value);  // Not consumed on failure
+    EXPECT_EQ(*value, 3);
+
+    EXPECT_TRUE(queue.try_pop_for(out, 20ms));
+    EXPECT_EQ(*out, 1);
+    EXPECT_TRUE(queue.push_for(std::move(value), 20ms));
+}
+
+TEST(BlockingMPMCQueueTest, CloseWakesWaitersAndDrains) {
+    BlockingMPMCQueue<int>   queue(4);
+    std::vector<std::thread> consumers;
+    std::atomic<int>         finished {0};
+    for (int i = 0; i < 3; ++i) {
+        consumers.emplace_back([&] {
+            int value;
+            while (queue.pop(value)) {}
+            finished.fetch_add(1);
+        });
+    }
+    EXPECT_TRUE(queue.push(1));
+    std::this_thread::sleep_for(20ms);
+    queue.close();
+    for (auto &t : consumers) {
+        t.join();
+    }
+    EXPECT_EQ(finished.load(), 3);
+    EXPECT_FALSE(queue.push(2));
+
+    BlockingMPMCQueue<int> closed(4);
+    EXPECT_TRUE(closed.push(5));
+    closed.close();
+    int value;
+    EXPECT_TRUE(closed.pop(value));
+    EXPECT_EQ(value, 5);
+    EXPECT_FALSE(closed.pop(value));
+}
+
+TEST(BlockingMPMCQueueTest, ManyProducersAndConsumers) {
+    constexpr int kProducers = 4;
+    constexpr int kConsumers = 4;
+    constexpr int kItems     = 5000;
+
+    BlockingMPMCQueue<int>   queue(16);
+    std::atomic<long>        sum {0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&] {
+            int value;
+            while (queue.pop(value)) {
+                sum.fetch_add(value);
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&] {
+            for (int i = 1; i <= kItems; ++i) {
+                EXPECT_TRUE(queue.push(i));
+            }
+        });
+    }
+    for (auto &t : producers) {
+        t.join();
+    }
+    while (!queue.empty()) {
+        std::this_thread::sleep_for(1ms);
+    }
+    queue.close();
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(sum.load(), static_cast<long>(kProducers) * kItems *
+                              (kItems + 1) / 2);
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "lc_bump_arena.h"
+
+using namespace lc;
+
+TEST(BumpArenaTest, AlignsAndRewindsOnReset) {
+    BumpArena arena(256);
+    void     *first = arena.allocate(3, 1);
+    void     *wide  = arena.allocate(8, 64);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(wide) % 64, 0u);
+    EXPECT_GE(arena.used(), 11u);
+
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.allocate(3, 1), first);
+}
+
+TEST(BumpArenaTest, ResetMergesOverflowIntoOneBlock) {
+    BumpArena arena(128);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_NE(arena.allocate(100), nullptr);
+    }
+    EXPECT_GT(arena.capacity(), 128u);
+    arena.reset();
+
+    // The merged block now serves the same pattern without growing.
+    size_t capacity = arena.capacity();
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_NE(arena.allocate(100), nullptr);
+    }
+    EXPECT_EQ(arena.capacity(), capacity);
+}
+
+TEST(BumpArenaTest, BacksPmrContainers) {
+    BumpArena             arena(64);
+    std::pmr::vector<int> values(&arena);
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(i);
+    }
+    EXPECT_EQ(values[999], 999);
+    EXPECT_GE(arena.used(), 1000 * sizeof(int));
+}
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lc_channel.h"
+#include "lc_coroutine.h"
+#include "lc_thread_pool.h"
+
+using namespace std::chrono_literals;
+using namespace lc;
+
+TEST(ChannelTest, SendRecvInOrder) {
+    Channel<int> channel(8);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(channel.send(i));
+    }
+    EXPECT_EQ(channel.size(), 5u);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(channel.recv(), i);
+    }
+    EXPECT_FALSE(channel.try_recv().has_value());
+}
+
+TEST(ChannelTest, BoundedSendBlocksUntilRecv) {
+    Channel<int> channel(2);
+    EXPECT_TRUE(channel.send(1));
+    EXPECT_TRUE(channel.send(2));
+    int value = 3;
+    EXPECT_FALSE(channel.try_send(value));
+
+    std::atomic<bool> sent {false};
+    std::thread       producer([&] {
+        EXPECT_TRUE(channel.send(3));
+        sent.store(true);
+    });
+    std::this_thread::sleep_for(20ms);
+    EXPECT_FALSE(sent.load());
+    EXPECT_EQ(channel.recv(), 1);
+    producer.join();
+    EXPECT_EQ(channel.recv(), 2);
+    EXPECT_EQ(channel.recv(), 3);
+}
+
+TEST(ChannelTest, UnboundedNeverBlocksAndKeepsOrder) {
+    Channel<int> channel(4, ChannelMode::Unbounded);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(channel.send(i));
+    }
+    EXPECT_EQ(channel.size(), 100u);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(channel.recv(), i);
+    }
+}
+
+TEST(ChannelTest, CloseDrainsThenEndsRangeFor) {
+    Channel<std::string> channel(8);
+    std::thread          producer([&] {
+        for (int i = 0; i < 3; ++i) {
+            channel.send(std::to_string(i));
+        }
+        channel.close();
+    });
+    std::vector<std::string> received;
+    for (auto &item : channel) {
+        received.push_back(item);
+    }
+    producer.join();
+    EXPECT_EQ(received, (std::vector<std::string> {"0", "1", "2"}));
+    EXPECT_FALSE(channel.send("late"));
+    EXPECT_FALSE(channel.recv().has_value());
+}
+
+TEST(ChannelTest, CloseWakesParkedSendersAndReceivers) {
+    Channel<int> empty(2);
+    std::thread  receiver([&] { EXPECT_FALSE(empty.recv().has_value()); });
+
+    Channel<int> full(2);
+    EXPECT_TRUE(full.send(1));
+    EXPECT_TRUE(full.send(2));
+    std::thread sender([&] { EXPECT_FALSE(full.send(3)); });
+
+    std::this_thread::sleep_for(20ms);
+    empty.close();
+    full.close();
+    receiver.join();
+    sender.join();
+}
+
+TEST(ChannelTest, SelectPicksReadyChannel) {
+    Channel<int>         numbers(4);
+    Channel<std::string> words(4);
+    EXPECT_TRUE(words.send("hello"));
+
+    std::string word;
+    size_t      fired = select(
+        on_recv(numbers, [](std::optional<int>) { FAIL(); }),
+        on_recv(words, [&](std::optional<std::string> w) { word = *w; }));
+    EXPECT_EQ(fired, 1u);
+    EXPECT_EQ(word, "hello");
+
+    // Nothing ready: select parks until a sender shows up.
+    std::thread sender([&] {
+        std::this_thread::sleep_for(20ms);
+        numbers.send(42);
+    });
+    int number = 0;
+    fired      = select(
+        on_recv(numbers, [&](std::optional<int> n) { number = *n; }),
+        on_recv(words, [](std::optional<std::string>) { FAIL(); }));
+    sender.join();
+    EXPECT_EQ(fired, 0u);
+    EXPECT_EQ(number, 42);
+
+    // A select that lost must not swallow later items.
+    EXPECT_TRUE(words.send("again"));
+    EXPECT_EQ(words.recv(), "again");
+}
+
+TEST(ChannelTest, ManyProducersAndConsumers) {
+    constexpr int kProducers = 4;
+    constexpr int kItems     = 2000;
+
+    Channel<int>             channel(8);
+    std::atomic<long>        sum {0};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 3; ++c) {
+        consumers.emplace_back([&] {
+            for (int value : channel) {
+                sum.fetch_add(value);
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&] {
+            for (int i = 1; i <= kItems; ++i) {
+                EXPECT_TRUE(channel.send(i));
+            }
+        });
+    }
+    for (auto &t : producers) {
+        t.join();
+    }
+    channel.close();
+    for (auto &t : consumers) {
+        t.join();
+    }
+    EXPECT_EQ(sum.load(), static_cast<long>(kProducers) * kItems *
+                              (kItems + 1) / 2);
+}
+
+static DetachedTask consume(Channel<int>       &channel,
+                            ThreadPool<2>      &pool,
+                            std::promise<long> &result) {
+    long sum = 0;
+    while (auto item = co_await channel.recv_async(pool)) {
+        sum += *item;
+    }
+    result.set_value(sum);
+}
+
+static DetachedTask produce(Channel<int> &channel, ThreadPool<2> &pool) {
+    co_await resume_on(pool);
+    for (int i = 1; i <= 100; ++i) {
+        EXPECT_TRUE(co_await channel.send_async(pool, i));
+    }
+    channel.close();
+}
+
+TEST(ChannelTest, CoroutinesWaitWithoutBlockingWorkers) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    auto          queue = std::make_shared<MPMCQueue<Task>>(256);
+    ThreadPool<2> pool(queue);
+    Channel<int>  channel(2);
+
+    std::promise<long> result;
+    auto               future = result.get_future();
+    consume(channel, pool, result);  // Parks: nothing sent yet
+
+    // Both workers stay available while the consumer is suspended.
+    EXPECT_EQ(pool.submit([] { return 1; }).get(), 1);
+    EXPECT_EQ(pool.submit([] { return 2; }).get(), 2);
+
+    produce(channel, pool);
+    ASSERT_EQ(future.wait_for(2s), std::future_status::ready);
+    EXPECT_EQ(future.get(), 5050);
+    pool.shutdown();
+}
+
+static DetachedTask receive_one(Channel<int>                  &channel,
+                                ThreadPool<1>                 &pool,
+                                std::promise<std::thread::id> &resumed_on) {
+    auto item = co_await channel.recv_async(pool);
+    EXPECT_EQ(item, 42);
+    resumed_on.set_value(std::this_thread::get_id());
+}
+
+TEST(ChannelTest, FullExecutorResumesCoroutineInline) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    auto          queue = std::make_shared<MPMCQueue<Task>>(2);
+    ThreadPool<1> pool(queue);
+    Channel<int>  channel(2);
+
+    std::promise<std::thread::id> resumed_on;
+    auto                          resumed = resumed_on.get_future();
+    receive_one(channel, pool, resumed_on);  // Parks
+
+    // Hold the only worker and fill the pool queue behind it.
+    std::promise<void> release;
+    std::promise<void> started;
+    auto               gate    = release.get_future().share();
+    auto               blocker = pool.submit([&started, gate] {
+        started.set_value();
+        gate.wait();
+    });
+    started.get_future().wait();
+    std::vector<std::future<void>> fillers;
+    while (auto filler = pool.try_submit([] {})) {
+        fillers.push_back(std::move(*filler));
+    }
+
+    // The hand-off succeeds although the executor rejects the resumption.
+    EXPECT_NO_THROW(EXPECT_TRUE(channel.send(42)));
+    ASSERT_EQ(resumed.wait_for(0s), std::future_status::ready);
+    EXPECT_EQ(resumed.get(), std::this_thread::get_id());
+
+    release.set_value();
+    blocker.get();
+    pool.shutdown();
+}
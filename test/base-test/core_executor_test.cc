@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "lc_core_executor.h"
+#include "lc_coroutine.h"
+
+using namespace lc;
+
+namespace {
+
+using Executor = CoreExecutor<4, NoAffinity>;
+
+// Hops to every other core in turn, checking it comes back to its own.
+DetachedTask visit_cores(Executor &cores, std::promise<size_t> &done) {
+    size_t home = cores.this_core();
+    size_t sum  = 0;
+    for (size_t i = 0; i < 64; ++i) {
+        size_t target = (home + 1 + i % 3) % cores.size();
+        sum += co_await cores.submit_to_core(target, [&cores] {
+            return cores.this_core();
+        });
+        if (cores.this_core() != home) {
+            done.set_exception(std::make_exception_ptr(
+                std::logic_error("Resumed on the wrong core")));
+            co_return;
+        }
+    }
+    done.set_value(sum);
+}
+
+}  // namespace
+
+TEST(CoreExecutorTest, RunsOnTheRequestedCore) {
+    Executor cores;
+    EXPECT_EQ(cores.this_core(), Executor::kNoCore);
+    for (size_t core = 0; core < cores.size(); ++core) {
+        EXPECT_EQ(cores.submit_to_core(core, [&] { return cores.this_core(); })
+                      .get(),
+                  core);
+    }
+    EXPECT_THROW(cores.submit_to_core(4, [] {}), std::out_of_range);
+}
+
+TEST(CoreExecutorTest, AwaitingResumesOnTheOriginatingCore) {
+    Executor                          cores;
+    std::vector<std::promise<size_t>> done(cores.size());
+    for (size_t core = 0; core < cores.size(); ++core) {
+        cores.submit_to_core(core, [&, core] {
+            visit_cores(cores, done[core]);
+        });
+    }
+    for (size_t core = 0; core < cores.size(); ++core) {
+        // The 64 hops from `home` visit the other three cores in rotation.
+        size_t expected = 0;
+        for (size_t i = 0; i < 64; ++i) {
+            expected += (core + 1 + i % 3) % cores.size();
+        }
+        EXPECT_EQ(done[core].get_future().get(), expected);
+    }
+}
+
+TEST(CoreExecutorTest, PropagatesExceptions) {
+    Executor cores;
+    auto     failed = cores.submit_to_core(1, []() -> int {
+        throw std::runtime_error("shard offline");
+    });
+    EXPECT_THROW(failed.get(), std::runtime_error);
+}
+
+TEST(CoreExecutorTest, ShutdownDrainsMessagesSentBetweenCores) {
+    std::atomic<int> delivered {0};
+    Executor         cores(2);  // Tiny rings, so sends spill to inboxes
+    cores.submit_to_core(0, [&] {
+        for (int i = 0; i < 100; ++i) {
+            cores.submit_to_core(1 + i % 3, [&] { delivered.fetch_add(1); });
+        }
+    });
+    cores.shutdown();
+    EXPECT_EQ(delivered.load(), 100);
+    EXPECT_THROW(cores.submit_to_core(0, [] {}), std::runtime_error);
+}
+
+TEST(CoreExecutorTest, CoresFloodingEachOtherDoNotDeadlock) {
+    std::atomic<int> delivered {0};
+    Executor         cores(2);
+    // Cores 0 and 1 fill each other's ring and inbox at the same time; a
+    // blocked sender must keep draining what is sent to it.
+    auto flood = [&](size_t target) {
+        return [&, target] {
+            for (int i = 0; i < 200; ++i) {
+                cores.submit_to_core(target, [&] { delivered.fetch_add(1); });
+            }
+        };
+    };
+    auto first  = cores.submit_to_core(0, flood(1));
+    auto second = cores.submit_to_core(1, flood(0));
+    first.get();
+    second.get();
+    cores.shutdown();
+    EXPECT_EQ(delivered.load(), 400);
+}
+
+TEST(CoreExecutorTest, ShutdownRacingOutsidePostsLosesNothing) {
+    for (int round = 0; round < 20; ++round) {
+        Executor          cores;
+        std::atomic<int>  accepted {0};
+        std::atomic<int>  delivered {0};
+        std::atomic<bool> stopping {false};
+        std::thread       poster([&] {
+            try {
+                while (true) {
+                    // Stay well under the inbox capacity, so the only
+                    // failure left is the shutdown itself.
+                    while (accepted.load() - delivered.load() > 256) {
+                        std::this_thread::yield();
+                    }
+                    cores.submit_to_core(round % 4,
+                                         [&] { delivered.fetch_add(1); });
+                    accepted.fetch_add(1);
+                }
+            } catch (const std::runtime_error &) {
+                EXPECT_TRUE(stopping.load());
+            }
+        });
+        while (accepted.load() < 10) {
+            std::this_thread::yield();
+        }
+        stopping.store(true);
+        cores.shutdown();
+        poster.join();
+        EXPECT_EQ(delivered.load(), accepted.load());
+    }
+}
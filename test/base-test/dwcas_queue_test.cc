@@ -0,0 +1,89 @@
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "lc_dwcas_queue.h"
+
+using namespace lc;
+
+TEST(DWCASQueueTest, EnqueueDequeueSingleThread) {
+    DWCASQueue<int> queue(4);
+    EXPECT_TRUE(queue.empty());
+
+    EXPECT_TRUE(queue.enqueue(1));
+    EXPECT_TRUE(queue.enqueue(2));
+    EXPECT_EQ(queue.size(), 2u);
+
+    int out = 0;
+    EXPECT_TRUE(queue.dequeue(out));
+    EXPECT_EQ(out, 1);
+    EXPECT_EQ(queue.try_dequeue(), 2);
+    EXPECT_FALSE(queue.dequeue(out));
+}
+
+TEST(DWCASQueueTest, WrapsAroundWhenFull) {
+    DWCASQueue<uint64_t> queue(4);
+    for (uint64_t round = 0; round < 3; ++round) {
+        for (uint64_t i = 0; i < 4; ++i) {
+            EXPECT_TRUE(queue.enqueue(round * 4 + i));
+        }
+        EXPECT_FALSE(queue.enqueue(99));
+        for (uint64_t i = 0; i < 4; ++i) {
+            EXPECT_EQ(queue.try_dequeue(), round * 4 + i);
+        }
+        EXPECT_FALSE(queue.try_dequeue().has_value());
+    }
+}
+
+TEST(DWCASQueueTest, PointerPayload) {
+    int               values[3] = {10, 20, 30};
+    DWCASQueue<int *> queue(8);
+    for (int &value : values) {
+        EXPECT_TRUE(queue.enqueue(&value));
+    }
+    for (int &value : values) {
+        EXPECT_EQ(queue.try_dequeue(), &value);
+    }
+}
+
+TEST(DWCASQueueTest, ManyProducersManyConsumers) {
+    constexpr int          kThreads = 4;
+    constexpr int          kItems   = 20000;
+    DWCASQueue<int>        queue(64);
+    std::atomic<int>       consumed {0};
+    std::atomic<long long> sum {0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&queue, t] {
+            for (int i = 0; i < kItems; ++i) {
+                while (!queue.enqueue(t * kItems + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&] {
+            int value;
+            while (consumed.load() < kThreads * kItems) {
+                if (queue.dequeue(value)) {
+                    sum.fetch_add(value);
+                    consumed.fetch_add(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    long long n = static_cast<long long>(kThreads) * kItems;
+    EXPECT_EQ(consumed.load(), n);
+    EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+    EXPECT_TRUE(queue.empty());
+}
@@ -1,6 +1,9 @@
 
 #include <gtest/gtest.h>
 
+#include <optional>
+#include <stdexcept>
+
 #include "lc_mpmc_queue.h"
 
 using namespace lc;
@@ -46,6 +49,17 @@ TEST(MPMCQueueTest, MoveOnlyTypeWorks) {
     EXPECT_EQ(*out, 42);
 }
 
+TEST(MPMCQueueTest, FailedEnqueueKeepsValue) {
+    MPMCQueue<std::unique_ptr<int>> queue(2);
+    EXPECT_TRUE(queue.enqueue(std::make_unique<int>(1)));
+    EXPECT_TRUE(queue.enqueue(std::make_unique<int>(2)));
+
+    auto value = std::make_unique<int>(3);
+    EXPECT_FALSE(queue.enqueue(std::move(value)));
+    ASSERT_TRUE(value);
+    EXPECT_EQ(*value, 3);
+}
+
 TEST(MPMCQueueTest, MultiThreadedEnqueueDequeue) {
     constexpr size_t queue_size       = 1024;
     constexpr size_t num_threads      = 4;
@@ -85,3 +99,137 @@ TEST(MPMCQueueTest, MultiThreadedEnqueueDequeue) {
 
     EXPECT_EQ(received.size(), num_threads * items_per_thread);
 }
+
+TEST(MPMCQueueTest, SizeTracksOccupancy) {
+    MPMCQueue<int> queue(8);
+    EXPECT_EQ(queue.capacity(), 8u);
+    EXPECT_TRUE(queue.empty());
+
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(queue.enqueue(i));
+    }
+    EXPECT_EQ(queue.size(), 5u);
+    EXPECT_FALSE(queue.empty());
+
+    int out;
+    EXPECT_TRUE(queue.dequeue(out));
+    EXPECT_TRUE(queue.dequeue(out));
+    EXPECT_EQ(queue.size(), 3u);
+
+    while (queue.enqueue(0)) {}
+    EXPECT_EQ(queue.size(), queue.capacity());
+    while (queue.dequeue(out)) {}
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MPMCQueueTest, HighWaterMarkRecordsPeakOccupancy) {
+    MPMCQueue<int> queue(1024);
+    for (int i = 0; i < 300; ++i) {
+        EXPECT_TRUE(queue.enqueue(i));
+    }
+    int out;
+    while (queue.dequeue(out)) {}
+
+    // Sampled, so the peak is seen to within one sample period.
+    EXPECT_LE(queue.high_water_mark(), 300u);
+    EXPECT_GT(queue.high_water_mark(), 300u - 64u);
+
+    queue.reset_high_water_mark();
+    EXPECT_EQ(queue.high_water_mark(), 0u);
+
+    MPMCQueue<int> small(4);
+    while (small.enqueue(0)) {}
+    EXPECT_EQ(small.high_water_mark(), small.capacity());
+}
+
+namespace {
+
+// Counts live objects and copies/moves, and has no default constructor.
+struct Tracked {
+    static inline int live  = 0;
+    static inline int moves = 0;
+
+    Tracked(int a, int b) : value(a + b) {
+        ++live;
+    }
+
+    Tracked(Tracked &&other) noexcept : value(other.value) {
+        ++live;
+        ++moves;
+    }
+
+    Tracked(const Tracked &)            = delete;
+    Tracked &operator=(const Tracked &) = delete;
+
+    ~Tracked() {
+        --live;
+    }
+
+    int value;
+};
+
+struct ThrowsOnNegative {
+    explicit ThrowsOnNegative(int v) : value(v) {
+        if (v < 0) {
+            throw std::runtime_error("negative");
+        }
+    }
+
+    int value;
+};
+
+}  // namespace
+
+TEST(MPMCQueueTest, EmplaceConstructsInPlace) {
+    Tracked::live  = 0;
+    Tracked::moves = 0;
+    {
+        MPMCQueue<Tracked> queue(4);
+        EXPECT_TRUE(queue.emplace(1, 2));
+        EXPECT_TRUE(queue.emplace(3, 4));
+        EXPECT_EQ(Tracked::moves, 0);
+        EXPECT_EQ(Tracked::live, 2);
+
+        int seen = 0;
+        EXPECT_TRUE(queue.consume([&](Tracked &&item) { seen = item.value; }));
+        EXPECT_EQ(seen, 3);
+        EXPECT_EQ(Tracked::moves, 0);
+        EXPECT_EQ(Tracked::live, 1);
+
+        std::optional<Tracked> out = queue.try_dequeue();
+        ASSERT_TRUE(out.has_value());
+        EXPECT_EQ(out->value, 7);
+        EXPECT_EQ(Tracked::moves, 1);
+        EXPECT_FALSE(queue.try_dequeue().has_value());
+        EXPECT_FALSE(queue.consume([](Tracked &&) {}));
+    }
+    EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(MPMCQueueTest, DestructorDestroysQueuedElements) {
+    Tracked::live = 0;
+    {
+        MPMCQueue<Tracked> queue(8);
+        for (int i = 0; i < 5; ++i) {
+            EXPECT_TRUE(queue.emplace(i, i));
+        }
+        EXPECT_TRUE(queue.consume([](Tracked &&) {}));
+        EXPECT_EQ(Tracked::live, 4);
+    }
+    EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(MPMCQueueTest, ThrowingConstructorLeavesQueueUsable) {
+    MPMCQueue<ThrowsOnNegative> queue(4);
+    EXPECT_TRUE(queue.emplace(1));
+    EXPECT_THROW((void)queue.emplace(-1), std::runtime_error);
+    EXPECT_TRUE(queue.emplace(2));
+
+    auto first = queue.try_dequeue();
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->value, 1);
+    auto second = queue.try_dequeue();
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->value, 2);
+    EXPECT_FALSE(queue.try_dequeue().has_value());
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lc_multi_queue.h"
+#include "lc_thread_pool.h"
+
+using namespace lc;
+
+TEST(MultiQueueTest, RejectsEmptyConfiguration) {
+    EXPECT_THROW(MultiQueue<int>(0, 4), std::invalid_argument);
+    EXPECT_THROW(MultiQueue<int>(16, 0), std::invalid_argument);
+}
+
+TEST(MultiQueueTest, SingleHeapIsExactWithFifoTies) {
+    struct Job {
+        int         priority;
+        std::string name;
+    };
+    auto by_priority = [](const Job &job) -> int64_t { return job.priority; };
+    MultiQueue<Job, decltype(by_priority)> queue(16, 1, by_priority);
+
+    EXPECT_TRUE(queue.emplace(Job {1, "a"}));
+    EXPECT_TRUE(queue.emplace(Job {5, "b"}));
+    EXPECT_TRUE(queue.emplace(Job {1, "c"}));
+    EXPECT_TRUE(queue.emplace(Job {3, "d"}));
+    EXPECT_EQ(queue.size(), 4u);
+
+    std::string order;
+    while (auto job = queue.try_dequeue()) {
+        order += job->name;
+    }
+    EXPECT_EQ(order, "bdac");
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MultiQueueTest, FailsOnlyWhenEveryHeapIsFull) {
+    MultiQueue<int> queue(8, 4);
+    EXPECT_EQ(queue.capacity(), 8u);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(queue.enqueue(i));
+    }
+    int rejected = 8;
+    EXPECT_FALSE(queue.enqueue(std::move(rejected)));
+    EXPECT_EQ(rejected, 8);
+
+    std::vector<int> values;
+    int              value;
+    while (queue.dequeue(value)) {
+        values.push_back(value);
+    }
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(values, (std::vector<int> {0, 1, 2, 3, 4, 5, 6, 7}));
+}
+
+TEST(MultiQueueTest, RelaxedOrderStaysCloseToPriority) {
+    constexpr int kItems = 1024;
+
+    MultiQueue<int> queue(kItems, 4);
+    for (int i = 0; i < kItems; ++i) {
+        EXPECT_TRUE(queue.enqueue(i));
+    }
+    // Each pop is the best of two of four heaps, so the first quarter of
+    // the pops comes almost entirely from the top half.
+    int from_top_half = 0;
+    for (int i = 0; i < kItems / 4; ++i) {
+        if (*queue.try_dequeue() >= kItems / 2) {
+            ++from_top_half;
+        }
+    }
+    EXPECT_GT(from_top_half, kItems / 4 * 9 / 10);
+}
+
+TEST(MultiQueueTest, ManyProducersAndConsumers) {
+    constexpr int kThreads = 4;
+    constexpr int kItems   = 5000;
+
+    MultiQueue<int>  queue(256, 8);
+    std::atomic<int> received {0};
+    std::vector<int> seen(kThreads * kItems, 0);
+    std::mutex       seen_mutex;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kItems; ++i) {
+                while (!queue.enqueue(t * kItems + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&] {
+            while (received.load() < kThreads * kItems) {
+                if (auto value = queue.try_dequeue()) {
+                    std::lock_guard<std::mutex> lock(seen_mutex);
+                    ++seen[*value];
+                    received.fetch_add(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), 1), kThreads * kItems);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MultiQueueTest, SchedulesPoolTasksByMetadataPriority) {
+    struct PriorityMetadata {
+        int priority = 0;
+    };
+    using Task = Context<PriorityMetadata, std::function<void()>>;
+
+    auto queue = std::make_shared<MultiQueue<Task>>(64, 1);
+    ThreadPool<1, PriorityMetadata, AtomicWaitStrategy, MultiQueue> pool(
+        queue);
+
+    // Hold the only worker so the rest queue up behind it.
+    std::promise<void> release;
+    auto               blocker = pool.submit(
+        PriorityMetadata {}, [gate = release.get_future().share()] {
+            gate.wait();
+        });
+    while (!queue->empty()) {
+        std::this_thread::yield();
+    }
+
+    std::mutex       order_mutex;
+    std::vector<int> order;
+    std::vector<std::future<void>> results;
+    for (int priority : {2, 7, 1, 9, 4}) {
+        results.push_back(
+            pool.submit(PriorityMetadata {priority}, [&, priority] {
+                std::lock_guard<std::mutex> lock(order_mutex);
+                order.push_back(priority);
+            }));
+    }
+    release.set_value();
+    blocker.get();
+    for (auto &result : results) {
+        result.get();
+    }
+    EXPECT_EQ(order, (std::vector<int> {9, 7, 4, 2, 1}));
+}
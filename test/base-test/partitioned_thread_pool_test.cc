@@ -0,0 +1,100 @@
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lc_partitioned_thread_pool.h"
+
+using namespace std::chrono_literals;
+using namespace lc;
+
+TEST(PartitionedThreadPoolTest, RunsTasksInEveryPartition) {
+    PartitionedThreadPool<4> pool({{}, {}, {}});
+
+    std::vector<std::future<size_t>> results;
+    for (size_t p = 0; p < pool.partition_count(); ++p) {
+        for (int i = 0; i < 10; ++i) {
+            results.push_back(pool.submit(p, [p] { return p; }));
+        }
+    }
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(results[i].get(), i / 10);
+    }
+    pool.shutdown();
+}
+
+TEST(PartitionedThreadPoolTest, InvalidPartitionThrows) {
+    PartitionedThreadPool<1> pool({{}});
+    EXPECT_THROW(pool.submit(1, [] {}), std::out_of_range);
+    EXPECT_THROW(PartitionedThreadPool<1>({{.weight = 0}}),
+                 std::invalid_argument);
+}
+
+TEST(PartitionedThreadPoolTest, MaxWorkersCapsConcurrency) {
+    PartitionedThreadPool<4> pool({{.max_workers = 1}});
+
+    std::atomic<int> running {0};
+    std::atomic<int> peak {0};
+
+    std::vector<std::future<void>> results;
+    for (int i = 0; i < 20; ++i) {
+        results.push_back(pool.submit(0, [&] {
+            int now = running.fetch_add(1) + 1;
+            int old = peak.load();
+            while (now > old && !peak.compare_exchange_weak(old, now)) {}
+            std::this_thread::sleep_for(1ms);
+            running.fetch_sub(1);
+        }));
+    }
+    for (auto &result : results) {
+        result.get();
+    }
+    EXPECT_EQ(peak.load(), 1);
+    pool.shutdown();
+}
+
+TEST(PartitionedThreadPoolTest, NoisyPartitionDoesNotStarveOthers) {
+    PartitionedThreadPool<4> pool({{.max_workers = 2}, {}});
+
+    for (int i = 0; i < 500; ++i) {
+        pool.submit(0, [] { std::this_thread::sleep_for(1ms); });
+    }
+    auto start = std::chrono::steady_clock::now();
+    pool.submit(1, [] {}).get();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 100ms);
+    pool.shutdown();
+}
+
+TEST(PartitionedThreadPoolTest, WeightsShapeServiceOrder) {
+    PartitionedThreadPool<1> pool({{.weight = 3}, {.weight = 1}});
+
+    std::promise<void> gate;
+    auto               opened = gate.get_future();
+    pool.submit(1, [&opened] { opened.wait(); });
+
+    std::mutex          mtx;
+    std::vector<size_t> order;
+    for (size_t p = 0; p < 2; ++p) {
+        for (int i = 0; i < 40; ++i) {
+            pool.submit(p, [&, p] {
+                std::scoped_lock<std::mutex> lock(mtx);
+                order.push_back(p);
+            });
+        }
+    }
+    gate.set_value();
+    pool.shutdown();
+
+    ASSERT_EQ(order.size(), 80u);
+    size_t first = 0;
+    for (size_t i = 0; i < 40; ++i) {
+        first += order[i] == 0;
+    }
+    EXPECT_GE(first, 28u);
+    EXPECT_LE(first, 32u);
+}
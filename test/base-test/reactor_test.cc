@@ -0,0 +1,207 @@
+
+#include <gtest/gtest.h>
+
+#include "lc_config.h"
+
+#if defined(LC_PLATFORM_LINUX)
+
+#  include <sys/socket.h>
+#  include <unistd.h>
+
+#  include <atomic>
+#  include <chrono>
+#  include <ctime>
+#  include <future>
+#  include <memory>
+#  include <stdexcept>
+#  include <thread>
+
+#  include "lc_reactor.h"
+#  include "lc_thread_pool.h"
+
+using namespace std::chrono_literals;
+using namespace lc;
+
+using Task = Context<EmptyMetadata, std::function<void()>>;
+
+TEST(ReactorTest, HandlerRunsOnPoolWorker) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    auto strategy = std::make_shared<ReactorWaitStrategy>();
+    auto queue    = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<4, EmptyMetadata, ReactorWaitStrategy> pool(queue, strategy);
+
+    std::promise<std::thread::id> handled;
+    auto                          future = handled.get_future();
+    strategy->reactor().add(fds[1], EPOLLIN, [&](uint32_t events) {
+        char byte;
+        EXPECT_TRUE(events & EPOLLIN);
+        EXPECT_EQ(::read(fds[1], &byte, 1), 1);
+        handled.set_value(std::this_thread::get_id());
+    });
+
+    char byte = 'x';
+    ASSERT_EQ(::write(fds[0], &byte, 1), 1);
+    ASSERT_EQ(future.wait_for(2s), std::future_status::ready);
+    EXPECT_NE(future.get(), std::this_thread::get_id());
+
+    strategy->reactor().remove(fds[1]);
+    pool.shutdown();
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(ReactorTest, SubmitWakesPollingLeader) {
+    auto strategy = std::make_shared<ReactorWaitStrategy>();
+    auto queue    = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<2, EmptyMetadata, ReactorWaitStrategy> pool(queue, strategy);
+
+    // Give the workers time to park inside epoll_wait.
+    std::this_thread::sleep_for(50ms);
+    auto fut = pool.submit([] { return 7; });
+    ASSERT_EQ(fut.wait_for(2s), std::future_status::ready);
+    EXPECT_EQ(fut.get(), 7);
+
+    pool.shutdown();
+}
+
+TEST(ReactorTest, HandlerIsRearmedAndNeverConcurrent) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    auto strategy = std::make_shared<ReactorWaitStrategy>();
+    auto queue    = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<4, EmptyMetadata, ReactorWaitStrategy> pool(queue, strategy);
+
+    constexpr int    kMessages = 100;
+    std::atomic<int> received {0};
+    std::atomic<int> inside {0};
+    std::atomic<int> overlaps {0};
+    strategy->reactor().add(fds[1], EPOLLIN, [&](uint32_t) {
+        if (inside.fetch_add(1) != 0) {
+            overlaps.fetch_add(1);
+        }
+        char    buf[kMessages];
+        ssize_t n = ::read(fds[1], buf, sizeof(buf));
+        if (n > 0) {
+            received.fetch_add(static_cast<int>(n));
+        }
+        inside.fetch_sub(1);
+    });
+
+    for (int i = 0; i < kMessages; ++i) {
+        char byte = 'x';
+        ASSERT_EQ(::write(fds[0], &byte, 1), 1);
+    }
+    for (int i = 0; i < 200 && received.load() < kMessages; ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    EXPECT_EQ(received.load(), kMessages);
+    EXPECT_EQ(overlaps.load(), 0);
+
+    strategy->reactor().remove(fds[1]);
+    pool.shutdown();
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(ReactorTest, SharedReactorOutlivesPoolShutdown) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    auto reactor = std::make_shared<Reactor>();
+    {
+        auto strategy = std::make_shared<ReactorWaitStrategy>(reactor);
+        auto queue    = std::make_shared<MPMCQueue<Task>>(64);
+        ThreadPool<2, EmptyMetadata, ReactorWaitStrategy> pool(queue,
+                                                               strategy);
+        EXPECT_EQ(pool.submit([] { return 1; }).get(), 1);
+        pool.shutdown();
+    }
+
+    // The pool is gone, but the reactor it shared still dispatches.
+    bool handled = false;
+    reactor->add(fds[1], EPOLLIN, [&](uint32_t) {
+        char byte;
+        EXPECT_EQ(::read(fds[1], &byte, 1), 1);
+        handled = true;
+    });
+    char byte = 'x';
+    ASSERT_EQ(::write(fds[0], &byte, 1), 1);
+    for (int i = 0; i < 10 && !handled; ++i) {
+        reactor->poll(100);
+    }
+    EXPECT_TRUE(handled);
+
+    reactor->remove(fds[1]);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(ReactorTest, ThrowingHandlerIsRearmed) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    auto strategy = std::make_shared<ReactorWaitStrategy>();
+    auto queue    = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<2, EmptyMetadata, ReactorWaitStrategy> pool(queue, strategy);
+
+    std::atomic<int> calls {0};
+    strategy->reactor().add(fds[1], EPOLLIN, [&](uint32_t) {
+        char byte;
+        EXPECT_EQ(::read(fds[1], &byte, 1), 1);
+        calls.fetch_add(1);
+        throw std::runtime_error("handler failed");
+    });
+
+    for (int i = 0; i < 2; ++i) {
+        char byte = 'x';
+        ASSERT_EQ(::write(fds[0], &byte, 1), 1);
+        for (int j = 0; j < 200 && calls.load() <= i; ++j) {
+            std::this_thread::sleep_for(10ms);
+        }
+    }
+    EXPECT_EQ(calls.load(), 2);
+    EXPECT_EQ(pool.submit([] { return 5; }).get(), 5);
+
+    strategy->reactor().remove(fds[1]);
+    pool.shutdown();
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(ReactorTest, StoppedReactorParksIdleWorkers) {
+    auto strategy = std::make_shared<ReactorWaitStrategy>();
+    auto queue    = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<2, EmptyMetadata, ReactorWaitStrategy> pool(queue, strategy);
+    strategy->reactor().stop();
+
+    // Spinning workers would burn about 100ms of CPU each here.
+    std::this_thread::sleep_for(20ms);
+    std::clock_t before = std::clock();
+    std::this_thread::sleep_for(100ms);
+    double cpu_ms = 1000.0 * static_cast<double>(std::clock() - before) /
+                    CLOCKS_PER_SEC;
+    EXPECT_LT(cpu_ms, 50.0);
+
+    EXPECT_EQ(pool.submit([] { return 9; }).get(), 9);
+    pool.shutdown();
+}
+
+TEST(ReactorTest, DuplicateRegistrationThrows) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    Reactor reactor;
+    reactor.add(fds[0], EPOLLIN, [](uint32_t) {});
+    EXPECT_THROW(reactor.add(fds[0], EPOLLIN, [](uint32_t) {}),
+                 std::invalid_argument);
+    EXPECT_THROW(reactor.modify(fds[1], EPOLLIN), std::invalid_argument);
+    reactor.remove(fds[0]);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+#endif  // defined(LC_PLATFORM_LINUX)
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lc_scq_queue.h"
+#include "lc_thread_pool.h"
+
+using namespace lc;
+
+TEST(SCQueueTest, EnqueueDequeueSingleThread) {
+    SCQueue<std::string> queue(4);
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.capacity(), 4u);
+
+    EXPECT_TRUE(queue.enqueue("a"));
+    EXPECT_TRUE(queue.emplace(3, 'b'));
+    EXPECT_EQ(queue.size(), 2u);
+
+    std::string out;
+    EXPECT_TRUE(queue.dequeue(out));
+    EXPECT_EQ(out, "a");
+    EXPECT_EQ(queue.try_dequeue(), "bbb");
+    EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+TEST(SCQueueTest, FullQueueRejectsAndWrapsAround) {
+    SCQueue<int> queue(8);
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 8; ++i) {
+            EXPECT_TRUE(queue.enqueue(round * 8 + i));
+        }
+        EXPECT_FALSE(queue.enqueue(-1));
+        for (int i = 0; i < 8; ++i) {
+            EXPECT_EQ(queue.try_dequeue(), round * 8 + i);
+        }
+        // Repeated polls of an empty ring must not stop later enqueues.
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_FALSE(queue.try_dequeue().has_value());
+        }
+    }
+}
+
+TEST(SCQueueTest, ThrowingConstructorReturnsTheCell) {
+    struct Picky {
+        explicit Picky(int v) : value(v) {
+            if (v < 0) {
+                throw std::runtime_error("negative");
+            }
+        }
+
+        int value;
+    };
+
+    SCQueue<Picky> queue(2);
+    EXPECT_THROW((void)queue.emplace(-1), std::runtime_error);
+    EXPECT_TRUE(queue.emplace(1));
+    EXPECT_TRUE(queue.emplace(2));
+    EXPECT_EQ(queue.try_dequeue()->value, 1);
+    EXPECT_EQ(queue.try_dequeue()->value, 2);
+}
+
+TEST(SCQueueTest, ManyProducersManyConsumers) {
+    constexpr int kProducers = 8;
+    constexpr int kConsumers = 8;
+    constexpr int kItems     = 5000;
+
+    SCQueue<int>     queue(16);
+    std::atomic<int> consumed {0};
+    std::mutex       mtx;
+    std::set<int>    received;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&queue, p] {
+            for (int i = 0; i < kItems; ++i) {
+                while (!queue.enqueue(p * kItems + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&] {
+            std::vector<int> local;
+            while (consumed.load() < kProducers * kItems) {
+                if (auto value = queue.try_dequeue()) {
+                    local.push_back(*value);
+                    consumed.fetch_add(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            std::scoped_lock<std::mutex> lock(mtx);
+            received.insert(local.begin(), local.end());
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(received.size(), size_t(kProducers * kItems));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SCQueueTest, ServesAsThreadPoolQueue) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    auto queue = std::make_shared<SCQueue<Task>>(256);
+    ThreadPool<4, EmptyMetadata, AtomicWaitStrategy, SCQueue> pool(queue);
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; ++i) {
+        results.push_back(pool.submit([i] { return i * 2; }));
+    }
+    int sum = 0;
+    for (auto &result : results) {
+        sum += result.get();
+    }
+    EXPECT_EQ(sum, 9900);
+}
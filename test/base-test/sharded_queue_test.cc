@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "lc_sharded_queue.h"
+#include "lc_thread_pool.h"
+
+using namespace lc;
+
+TEST(ShardedQueueTest, RejectsUnevenSplit) {
+    EXPECT_THROW(ShardedQueue<int>(10, 4), std::invalid_argument);
+    EXPECT_THROW(ShardedQueue<int>(24, 4), std::invalid_argument);
+    EXPECT_THROW(ShardedQueue<int>(16, 0), std::invalid_argument);
+}
+
+TEST(ShardedQueueTest, SingleProducerKeepsFifoOrder) {
+    ShardedQueue<int> queue(64, 4);
+    EXPECT_EQ(queue.capacity(), 64u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(queue.enqueue(i));
+    }
+    EXPECT_EQ(queue.size(), 10u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(queue.try_dequeue(), i);
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(ShardedQueueTest, SpillsIntoOtherShardsWhenHomeIsFull) {
+    ShardedQueue<int> queue(8, 4);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(queue.enqueue(i));
+    }
+    EXPECT_FALSE(queue.enqueue(8));
+    EXPECT_EQ(queue.size(), 8u);
+
+    std::set<int> seen;
+    int           value;
+    while (queue.dequeue(value)) {
+        seen.insert(value);
+    }
+    EXPECT_EQ(seen.size(), 8u);
+}
+
+TEST(ShardedQueueTest, ManyProducers) {
+    constexpr int kProducers = 8;
+    constexpr int kItems     = 5000;
+
+    ShardedQueue<int> queue(256, 8);
+    std::atomic<int>  done {0};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < kItems; ++i) {
+                while (!queue.enqueue(p * kItems + i)) {
+                    std::this_thread::yield();
+                }
+            }
+            done.fetch_add(1);
+        });
+    }
+
+    // Home shards overflow here, so only delivery is checked, not order.
+    std::vector<int> seen(kProducers * kItems, 0);
+    int              received = 0;
+    while (received < kProducers * kItems) {
+        if (auto value = queue.try_dequeue()) {
+            ++seen[*value];
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto &thread : producers) {
+        thread.join();
+    }
+    EXPECT_EQ(done.load(), kProducers);
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), 1), kProducers * kItems);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(ShardedQueueTest, ServesAsThreadPoolQueue) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    auto queue = std::make_shared<ShardedQueue<Task>>(256, 4);
+    ThreadPool<4, EmptyMetadata, AtomicWaitStrategy, ShardedQueue> pool(queue);
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; ++i) {
+        results.push_back(pool.submit([i] { return i; }));
+    }
+    int sum = 0;
+    for (auto &result : results) {
+        sum += result.get();
+    }
+    EXPECT_EQ(sum, 4950);
+}
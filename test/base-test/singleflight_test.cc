@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "lc_singleflight.h"
+#include "lc_thread_pool.h"
+
+using namespace lc;
+
+namespace {
+
+using Task = Context<EmptyMetadata, std::function<void()>>;
+
+}  // namespace
+
+TEST(SingleFlightTest, ConcurrentRequestsShareOneComputation) {
+    auto          queue = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<4> pool(queue);
+    SingleFlight<std::string, int> flights;
+
+    std::atomic<int>   calls {0};
+    std::promise<void> release;
+    auto               gate = release.get_future().share();
+    auto compute            = [&calls, gate] {
+        calls.fetch_add(1);
+        gate.wait();
+        return 42;
+    };
+
+    std::vector<std::shared_future<int>> results;
+    for (int i = 0; i < 16; ++i) {
+        results.push_back(pool.submit_dedup(flights, "key", compute));
+    }
+    EXPECT_EQ(flights.in_flight(), 1u);
+    release.set_value();
+    for (auto &result : results) {
+        EXPECT_EQ(result.get(), 42);
+    }
+    EXPECT_EQ(calls.load(), 1);
+
+    // Finished flights are not cached: the next request computes again.
+    pool.wait_idle();
+    EXPECT_EQ(flights.in_flight(), 0u);
+    EXPECT_EQ(pool.submit_dedup(flights, "key", compute).get(), 42);
+    EXPECT_EQ(calls.load(), 2);
+    pool.shutdown();
+}
+
+TEST(SingleFlightTest, DistinctKeysRunSeparately) {
+    auto          queue = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<4> pool(queue);
+    SingleFlight<int, int> flights(4);
+
+    std::vector<std::shared_future<int>> results;
+    for (int key = 0; key < 8; ++key) {
+        results.push_back(
+            pool.submit_dedup(flights, key, [key] { return key * key; }));
+    }
+    for (int key = 0; key < 8; ++key) {
+        EXPECT_EQ(results[key].get(), key * key);
+    }
+    pool.shutdown();
+}
+
+TEST(SingleFlightTest, ExceptionReachesEveryCaller) {
+    auto          queue = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<2> pool(queue);
+    SingleFlight<int, void> flights;
+
+    std::promise<void> release;
+    auto               gate = release.get_future().share();
+    auto first = pool.submit_dedup(flights, 1, [gate] {
+        gate.wait();
+        throw std::runtime_error("miss");
+    });
+    auto second = pool.submit_dedup(flights, 1, [] {});
+    release.set_value();
+    EXPECT_THROW(first.get(), std::runtime_error);
+    EXPECT_THROW(second.get(), std::runtime_error);
+    pool.shutdown();
+}
+
+TEST(SingleFlightTest, FailedLaunchFreesTheKey) {
+    SingleFlight<int, int> flights;
+    EXPECT_THROW(flights.start(
+                     1,
+                     [] { return 1; },
+                     [](auto &&) { throw std::runtime_error("full"); }),
+                 std::runtime_error);
+    EXPECT_EQ(flights.in_flight(), 0u);
+
+    // A callable dropped without running breaks the promise.
+    auto dropped = flights.start(1, [] { return 1; }, [](auto &&) {});
+    EXPECT_THROW(dropped.get(), std::future_error);
+    EXPECT_EQ(flights.in_flight(), 0u);
+}
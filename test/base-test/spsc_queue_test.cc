@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "lc_spsc_queue.h"
+
+using namespace lc;
+
+TEST(SPSCQueueTest, RejectsInvalidSize) {
+    EXPECT_THROW(SPSCQueue<int>(0), std::invalid_argument);
+    EXPECT_THROW(SPSCQueue<int>(6), std::invalid_argument);
+}
+
+TEST(SPSCQueueTest, FifoAndFullLeavesValueIntact) {
+    SPSCQueue<std::unique_ptr<int>> queue(4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.enqueue(std::make_unique<int>(i)));
+    }
+    auto extra = std::make_unique<int>(4);
+    EXPECT_FALSE(queue.enqueue(std::move(extra)));
+    ASSERT_NE(extra, nullptr);
+
+    for (int i = 0; i < 4; ++i) {
+        auto value = queue.try_dequeue();
+        ASSERT_TRUE(value);
+        EXPECT_EQ(**value, i);
+    }
+    EXPECT_FALSE(queue.try_dequeue());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SPSCQueueTest, TransfersInOrderAcrossThreads) {
+    constexpr int kItems = 20000;
+
+    SPSCQueue<int> queue(64);
+    std::thread    producer([&] {
+        for (int i = 0; i < kItems; ++i) {
+            while (!queue.enqueue(int {i})) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    int expected = 0;
+    while (expected < kItems) {
+        if (auto value = queue.try_dequeue()) {
+            ASSERT_EQ(*value, expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+}
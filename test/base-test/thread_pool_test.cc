@@ -1,9 +1,15 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <atomic>
 #include <future>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <set>
 #include <thread>
+#include <vector>
 
 #include "lc_thread_pool.h"
 
@@ -27,10 +33,9 @@ TEST(ThreadPoolTest, BasicVoidTask) {
         });
     }
 
-    std::this_thread::sleep_for(200ms);
-    pool.shutdown();
-
+    pool.wait_idle();
     EXPECT_EQ(counter.load(), 10);
+    pool.shutdown();
 }
 
 TEST(ThreadPoolTest, TaskWithReturnValue) {
@@ -74,8 +79,845 @@ TEST(ThreadPoolTest, ManyTasks) {
                     [&sum]() { sum.fetch_add(1, std::memory_order_relaxed); });
     }
 
-    std::this_thread::sleep_for(500ms);
+    pool.wait_idle();
+    EXPECT_EQ(sum.load(), kTaskCount);
     pool.shutdown();
+}
 
-    EXPECT_EQ(sum.load(), kTaskCount);
+TEST(ThreadPoolTest, BlockingRegionCompensatesBlockedWorkers) {
+    using Task = Context<TestMetadata, std::function<void()>>;
+    auto                        queue = std::make_shared<MPMCQueue<Task>>(128);
+    ThreadPool<2, TestMetadata> pool(queue);
+
+    std::promise<void> release;
+    auto               released = release.get_future().share();
+
+    // Both workers block on a result that only a later task produces.
+    std::vector<std::future<bool>> waiters;
+    for (int i = 0; i < 2; ++i) {
+        waiters.push_back(pool.submit(TestMetadata {.priority = 0}, [&] {
+            auto region = pool.blocking_region();
+            return released.wait_for(5s) == std::future_status::ready;
+        }));
+    }
+    pool.submit(TestMetadata {.priority = 0}, [&] { release.set_value(); });
+
+    for (auto &waiter : waiters) {
+        EXPECT_TRUE(waiter.get());
+    }
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, BlockingRegionReusesLingeringCompensationWorker) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    using Pool = ThreadPool<1>;
+    auto queue = std::make_shared<MPMCQueue<Task>>(16);
+
+    std::atomic<int> compensation_starts {0};
+    Pool             pool(queue, [&](Pool &, size_t worker) {
+        if (worker == Pool::kNoWorker) {
+            compensation_starts.fetch_add(1);
+        }
+    });
+
+    // The only worker blocks on a task that needs a compensation worker;
+    // back-to-back regions should keep reusing the same thread.
+    for (int round = 0; round < 5; ++round) {
+        auto outer = pool.submit([&pool] {
+            auto region = pool.blocking_region();
+            return pool.submit([] { return 3; }).get();
+        });
+        EXPECT_EQ(outer.get(), 3);
+    }
+    EXPECT_EQ(compensation_starts.load(), 1);
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, BlockingRegionOutsidePoolIsNoop) {
+    using Task = Context<TestMetadata, std::function<void()>>;
+    auto                        queue = std::make_shared<MPMCQueue<Task>>(16);
+    ThreadPool<1, TestMetadata> pool(queue);
+
+    {
+        auto region = pool.blocking_region();
+    }
+    auto fut = pool.submit(TestMetadata {.priority = 0}, [] { return 1; });
+    EXPECT_EQ(fut.get(), 1);
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, BlockingDetectionCompensatesStuckWorkers) {
+    using Task = Context<TestMetadata, std::function<void()>>;
+    auto                        queue = std::make_shared<MPMCQueue<Task>>(128);
+    ThreadPool<2, TestMetadata> pool(queue);
+    pool.enable_blocking_detection(20ms);
+
+    std::promise<void> release;
+    auto               released = release.get_future().share();
+
+    std::vector<std::future<bool>> waiters;
+    for (int i = 0; i < 2; ++i) {
+        waiters.push_back(pool.submit(TestMetadata {.priority = 0}, [&] {
+            return released.wait_for(5s) == std::future_status::ready;
+        }));
+    }
+    pool.submit(TestMetadata {.priority = 0}, [&] { release.set_value(); });
+
+    for (auto &waiter : waiters) {
+        EXPECT_TRUE(waiter.get());
+    }
+    pool.shutdown();
 }
+
+TEST(ThreadPoolTest, WatchdogReportsStuckTaskOnce) {
+    using Task = Context<TestMetadata, std::function<void()>>;
+    auto                        queue = std::make_shared<MPMCQueue<Task>>(128);
+    ThreadPool<2, TestMetadata> pool(queue);
+
+    std::mutex       mtx;
+    std::vector<int> reported;
+    pool.enable_watchdog(20ms, [&](const auto &stuck) {
+        EXPECT_GE(stuck.elapsed, 20ms);
+        EXPECT_LT(stuck.worker, 2u);
+        std::scoped_lock<std::mutex> lock(mtx);
+        reported.push_back(stuck.metadata.priority);
+    });
+
+    pool.submit(TestMetadata {.priority = 7}, [] {
+        std::this_thread::sleep_for(150ms);
+    }).get();
+    pool.submit(TestMetadata {.priority = 1}, [] {}).get();
+    pool.shutdown();
+
+    std::scoped_lock<std::mutex> lock(mtx);
+    ASSERT_EQ(reported.size(), 1u);
+    EXPECT_EQ(reported[0], 7);
+}
+
+struct ClassMetadata {
+    size_t task_class;
+};
+
+TEST(ThreadPoolTest, ConcurrencyLimitCapsTaskClass) {
+    using Task = Context<ClassMetadata, std::function<void()>>;
+    auto                         queue = std::make_shared<MPMCQueue<Task>>(128);
+    ThreadPool<4, ClassMetadata> pool(queue);
+    pool.set_concurrency_limit(1, 2);
+    EXPECT_THROW(pool.set_concurrency_limit(1, 3), std::logic_error);
+    EXPECT_THROW(pool.set_concurrency_limit(ThreadPool<4, ClassMetadata>::
+                                                kMaxTaskClasses,
+                                            1),
+                 std::out_of_range);
+
+    std::atomic<int> running {0};
+    std::atomic<int> peak {0};
+
+    std::vector<std::future<void>> limited;
+    for (int i = 0; i < 20; ++i) {
+        limited.push_back(pool.submit(ClassMetadata {.task_class = 1}, [&] {
+            int now = running.fetch_add(1) + 1;
+            int old = peak.load();
+            while (now > old && !peak.compare_exchange_weak(old, now)) {}
+            std::this_thread::sleep_for(2ms);
+            running.fetch_sub(1);
+        }));
+    }
+    // Unlimited classes still find free workers.
+    auto other = pool.submit(ClassMetadata {.task_class = 0}, [] { return 3; });
+    EXPECT_EQ(other.get(), 3);
+
+    for (auto &result : limited) {
+        result.get();
+    }
+    EXPECT_LE(peak.load(), 2);
+    EXPECT_GE(peak.load(), 1);
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, SubmitAfterDelaysTask) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    auto          queue = std::make_shared<MPMCQueue<Task>>(16);
+    ThreadPool<2> pool(queue);
+
+    auto start = std::chrono::steady_clock::now();
+    auto fut   = pool.submit_after(50ms, [start] {
+        return std::chrono::steady_clock::now() - start;
+    });
+    EXPECT_GE(fut.get(), 50ms);
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, RateLimitDefersWithoutBlockingProducer) {
+    using Task = Context<ClassMetadata, std::function<void()>>;
+    auto                         queue = std::make_shared<MPMCQueue<Task>>(128);
+    ThreadPool<2, ClassMetadata> pool(queue);
+    pool.set_rate_limit(2, 200.0);
+    EXPECT_THROW(pool.set_rate_limit(2, 100.0), std::logic_error);
+
+    constexpr int                  kTasks = 21;
+    std::vector<std::future<void>> results;
+    auto                           start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kTasks; ++i) {
+        results.push_back(
+            pool.submit(ClassMetadata {.task_class = 2}, [] {}));
+    }
+    auto submitted = std::chrono::steady_clock::now() - start;
+    for (auto &result : results) {
+        result.get();
+    }
+    auto finished = std::chrono::steady_clock::now() - start;
+
+    // 20 intervals of 5ms after the first token.
+    EXPECT_LT(submitted, 50ms);
+    EXPECT_GE(finished, 95ms);
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, DeferAfterShutdownThrowsWithoutLeakingTasks) {
+    using Task = Context<ClassMetadata, std::function<void()>>;
+    auto                         queue = std::make_shared<MPMCQueue<Task>>(16);
+    ThreadPool<1, ClassMetadata> pool(queue);
+    pool.set_rate_limit(2, 1.0);
+    pool.submit(ClassMetadata {.task_class = 2}, [] {}).get();
+    pool.shutdown();
+
+    // The timer is gone, so neither path can defer the task; a failed
+    // submit must not leave wait_idle() waiting for it.
+    EXPECT_THROW(pool.submit_after(1ms, ClassMetadata {}, [] {}),
+                 std::runtime_error);
+    EXPECT_THROW(pool.submit(ClassMetadata {.task_class = 2}, [] {}),
+                 std::runtime_error);
+    EXPECT_TRUE(pool.wait_idle_for(100ms));
+}
+
+TEST(ThreadPoolTest, AdmissionControllerAdjustsLimit) {
+    AdmissionController controller({.target_latency = 1ms,
+                                    .initial_limit  = 10,
+                                    .min_limit      = 2,
+                                    .max_limit      = 20});
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(controller.try_acquire());
+    }
+    EXPECT_FALSE(controller.try_acquire());
+
+    // One slow sample in the window triggers a multiplicative decrease.
+    for (int i = 0; i < 9; ++i) {
+        controller.release(0ns);
+    }
+    controller.release(5ms);
+    EXPECT_EQ(controller.limit(), 9u);
+
+    // A fast window that hit the limit grows it by one.
+    for (int i = 0; i < 9; ++i) {
+        ASSERT_TRUE(controller.try_acquire());
+    }
+    EXPECT_FALSE(controller.try_acquire());
+    for (int i = 0; i < 9; ++i) {
+        controller.release(0ns);
+    }
+    EXPECT_EQ(controller.limit(), 10u);
+
+    // A fast window that never hit the limit leaves it alone.
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(controller.try_acquire());
+        controller.release(0ns);
+    }
+    EXPECT_EQ(controller.limit(), 10u);
+    EXPECT_EQ(controller.inflight(), 0u);
+}
+
+TEST(ThreadPoolTest, AdmissionControlShedsExcessTasks) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    auto          queue = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<1> pool(queue);
+    EXPECT_EQ(pool.admission_limit(), 0u);
+    pool.set_admission_control({.initial_limit = 4});
+    EXPECT_THROW(pool.set_admission_control(), std::logic_error);
+    EXPECT_EQ(pool.admission_limit(), 4u);
+
+    std::promise<void>             gate;
+    std::shared_future<void>       opened = gate.get_future().share();
+    std::vector<std::future<void>> accepted;
+    for (int i = 0; i < 4; ++i) {
+        auto result = pool.try_submit([opened] { opened.wait(); });
+        ASSERT_TRUE(result.has_value());
+        accepted.push_back(std::move(*result));
+    }
+    EXPECT_FALSE(pool.try_submit([] {}).has_value());
+    EXPECT_THROW(pool.submit([] {}), std::runtime_error);
+
+    gate.set_value();
+    for (auto &result : accepted) {
+        result.get();
+    }
+    auto result = pool.try_submit([] { return 1; });
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->get(), 1);
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, CodelDropsStaleTasksUnderOverload) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    auto          queue = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<1> pool(queue);
+    pool.set_codel({.target_delay = 1ms, .interval = 10ms});
+    EXPECT_THROW(pool.set_codel(), std::logic_error);
+
+    // A long head-of-line task keeps every later task waiting well past the
+    // target for more than one interval.
+    auto blocker = pool.submit([] { std::this_thread::sleep_for(50ms); });
+    std::vector<std::future<void>> backlog;
+    for (int i = 0; i < 20; ++i) {
+        backlog.push_back(
+            pool.submit([] { std::this_thread::sleep_for(2ms); }));
+    }
+    blocker.get();
+    int dropped = 0;
+    for (auto &result : backlog) {
+        try {
+            result.get();
+        } catch (const std::future_error &e) {
+            EXPECT_EQ(e.code(), std::future_errc::broken_promise);
+            ++dropped;
+        }
+    }
+    EXPECT_GT(dropped, 0);
+    EXPECT_EQ(pool.dropped_tasks(), static_cast<size_t>(dropped));
+
+    // Fresh work is still served once the backlog is gone.
+    EXPECT_EQ(pool.submit([] { return 3; }).get(), 3);
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, CodelForgetsOverloadAfterIdleGap) {
+    Codel   codel({.target_delay = 1ms, .interval = 10ms});
+    int64_t ms = 1000000;
+
+    // A window whose fastest task still waited 5ms marks the next one
+    // overloaded.
+    EXPECT_FALSE(codel.should_drop(0, 5ms));
+    EXPECT_FALSE(codel.should_drop(5 * ms, 5ms));
+    EXPECT_FALSE(codel.should_drop(10 * ms, 5ms));
+    EXPECT_TRUE(codel.overloaded());
+    EXPECT_TRUE(codel.should_drop(12 * ms, 5ms));
+
+    // Nothing dequeued for several intervals: the first burst afterwards
+    // is not judged by the old window.
+    EXPECT_FALSE(codel.should_drop(60 * ms, 5ms));
+    EXPECT_FALSE(codel.overloaded());
+    EXPECT_FALSE(codel.should_drop(61 * ms, 5ms));
+}
+
+TEST(ThreadPoolTest, SubmitRangeCoversIndexSpaceWithFewQueueSlots) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    // Far fewer slots than indices: one entry stands for the whole range.
+    auto          queue = std::make_shared<MPMCQueue<Task>>(8);
+    ThreadPool<4> pool(queue);
+
+    constexpr size_t               kCount = 1 << 20;
+    std::vector<std::atomic<char>> hits(kCount);
+    pool.submit_range(kCount, [&hits](size_t i) {
+            hits[i].fetch_add(1, std::memory_order_relaxed);
+        }).get();
+    EXPECT_TRUE(std::all_of(hits.begin(), hits.end(), [](const auto &hit) {
+        return hit.load() == 1;
+    }));
+
+    // Chunked form with an explicit grain.
+    std::atomic<size_t> sum {0};
+    pool.submit_range(
+            1000,
+            [&sum](size_t begin, size_t end) {
+                EXPECT_LE(end - begin, 64u);
+                size_t local = 0;
+                for (size_t i = begin; i < end; ++i) {
+                    local += i;
+                }
+                sum.fetch_add(local);
+            },
+            64)
+        .get();
+    EXPECT_EQ(sum.load(), 999u * 1000u / 2);
+
+    pool.submit_range(0, [](size_t) { FAIL(); }).get();
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, SubmitRangeReportsFirstException) {
+    using Task = Context<TestMetadata, std::function<void()>>;
+    auto                        queue = std::make_shared<MPMCQueue<Task>>(16);
+    ThreadPool<4, TestMetadata> pool(queue);
+
+    std::atomic<size_t> ran {0};
+    auto                result = pool.submit_range(
+        TestMetadata {.priority = 0},
+        10000,
+        [&ran](size_t) {
+            ran.fetch_add(1);
+            throw std::runtime_error("failed");
+        },
+        1);
+    EXPECT_THROW(result.get(), std::runtime_error);
+    // Each claimer stops after its first failure.
+    EXPECT_LE(ran.load(), 4u);
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, WaitIdleCoversQueuedDelayedAndRangeWork) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    auto          queue = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<4> pool(queue);
+
+    pool.wait_idle();  // Nothing submitted yet
+    EXPECT_TRUE(pool.wait_idle_for(0ms));
+
+    std::atomic<int> counter {0};
+    for (int i = 0; i < 32; ++i) {
+        pool.submit([&counter] {
+            std::this_thread::sleep_for(100us);
+            counter.fetch_add(1);
+        });
+    }
+    pool.submit_after(5ms, [&counter] { counter.fetch_add(1); });
+    pool.submit_range(1000, [&counter](size_t) { counter.fetch_add(1); });
+    pool.wait_idle();
+    EXPECT_EQ(counter.load(), 32 + 1 + 1000);
+
+    // Waiting from inside a task could never succeed.
+    auto inner = pool.submit([&pool] { pool.wait_idle(); });
+    EXPECT_THROW(inner.get(), std::logic_error);
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, WaitIdleForTimesOutWhileBusy) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    auto          queue = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<2> pool(queue);
+
+    std::promise<void> release;
+    pool.submit([gate = release.get_future()] { gate.wait(); });
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(pool.wait_idle_for(20ms));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+
+    release.set_value();
+    EXPECT_TRUE(pool.wait_idle_for(5s));
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, WorkerLocalIsBuiltOncePerWorker) {
+    struct Scratch {
+        std::vector<char> buffer;
+        int               worker = -1;
+        int               uses   = 0;
+    };
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    using Pool = ThreadPool<4>;
+    auto queue = std::make_shared<MPMCQueue<Task>>(256);
+
+    std::atomic<int> inits {0};
+    Pool             pool(queue, [&](Pool &self, size_t worker) {
+        auto &scratch  = self.local<Scratch>();
+        scratch.worker = static_cast<int>(worker);
+        scratch.buffer.resize(4096);
+        inits.fetch_add(1);
+    });
+
+    std::mutex                     seen_mutex;
+    std::vector<int>               uses(4, 0);
+    std::vector<std::future<void>> results;
+    for (int i = 0; i < 200; ++i) {
+        results.push_back(pool.submit([&] {
+            auto &scratch = pool.local<Scratch>();
+            EXPECT_EQ(scratch.buffer.size(), 4096u);
+            std::lock_guard<std::mutex> lock(seen_mutex);
+            uses[scratch.worker] = ++scratch.uses;
+        }));
+    }
+    for (auto &result : results) {
+        result.get();
+    }
+    pool.shutdown();
+    EXPECT_EQ(inits.load(), 4);
+    int total = 0;
+    for (int count : uses) {
+        total += count;
+    }
+    EXPECT_EQ(total, 200);
+}
+
+TEST(ThreadPoolTest, ArenaIsResetAfterEachTask) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    auto          queue = std::make_shared<MPMCQueue<Task>>(64);
+    ThreadPool<1> pool(queue);
+
+    std::vector<std::future<size_t>> results;
+    for (int i = 0; i < 8; ++i) {
+        results.push_back(pool.submit([&pool] {
+            auto  &arena = pool.arena();
+            size_t before = arena.used();
+            std::pmr::vector<int> scratch(&arena);
+            scratch.resize(1000);
+            return before;
+        }));
+    }
+    for (auto &result : results) {
+        EXPECT_EQ(result.get(), 0u);
+    }
+    EXPECT_THROW(pool.arena(), std::logic_error);
+    EXPECT_THROW(pool.local<int>(), std::logic_error);
+    pool.shutdown();
+}
+
+struct AffinityConfig : DefaultPoolConfig {
+    static constexpr std::size_t kWorkerQueueSize = 64;
+};
+
+struct ShardMetadata {
+    size_t affinity_key = 0;
+};
+
+static_assert(AffinityMetadata<ShardMetadata>);
+static_assert(!AffinityMetadata<TestMetadata>);
+
+TEST(ThreadPoolTest, SubmitToRoutesAndStealsFromBusyWorkers) {
+    using Pool = BasicThreadPool<4, ShardMetadata, AffinityConfig>;
+    auto queue = std::make_shared<Pool::TaskQueue>(64);
+    Pool pool(queue, [](Pool &self, size_t worker) {
+        self.local<size_t>() = worker;
+    });
+    EXPECT_THROW(pool.submit_to(4, ShardMetadata {}, [] {}),
+                 std::out_of_range);
+
+    // Hold three workers, one at a time; the fourth is the only one left.
+    std::promise<void>  release;
+    auto                gate = release.get_future().share();
+    std::atomic<int>    held {0};
+    std::vector<size_t> busy(3);
+    std::vector<std::future<void>> blockers;
+    for (int i = 0; i < 3; ++i) {
+        blockers.push_back(pool.submit(ShardMetadata {}, [&, gate, i] {
+            busy[i] = pool.local<size_t>();
+            held.fetch_add(1);
+            gate.wait();
+        }));
+        while (held.load() <= i) {
+            std::this_thread::yield();
+        }
+    }
+    size_t free_worker = 6 - busy[0] - busy[1] - busy[2];
+
+    auto on_worker = [&pool] { return pool.local<size_t>(); };
+    EXPECT_EQ(pool.submit_to(free_worker, ShardMetadata {}, on_worker).get(),
+              free_worker);
+    // Queued on a busy worker, so the free one steals it.
+    EXPECT_EQ(pool.submit_to(busy[0], ShardMetadata {}, on_worker).get(),
+              free_worker);
+    // Keyed tasks land on every worker's queue and still all complete.
+    std::vector<std::future<size_t>> keyed;
+    for (size_t key = 0; key < 16; ++key) {
+        keyed.push_back(pool.submit(ShardMetadata {key}, on_worker));
+    }
+    for (auto &result : keyed) {
+        EXPECT_EQ(result.get(), free_worker);
+    }
+
+    release.set_value();
+    for (auto &blocker : blockers) {
+        blocker.get();
+    }
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, RoutedTasksWakeTheirIdleWorker) {
+    using Pool = BasicThreadPool<4, ShardMetadata, AffinityConfig>;
+    auto queue = std::make_shared<Pool::TaskQueue>(64);
+    Pool pool(queue, [](Pool &self, size_t worker) {
+        self.local<size_t>() = worker;
+    });
+    auto on_worker = [&pool] { return pool.local<size_t>(); };
+    auto home      = [](size_t key) { return std::hash<size_t> {}(key) % 4; };
+
+    // Every worker is idle before each task, so none may take another's.
+    for (size_t i = 0; i < 200; ++i) {
+        size_t worker = i % 4;
+        pool.wait_idle();
+        EXPECT_EQ(pool.submit_to(worker, ShardMetadata {}, on_worker).get(),
+                  worker);
+    }
+    for (size_t key = 0; key < 100; ++key) {
+        pool.wait_idle();
+        EXPECT_EQ(pool.submit(ShardMetadata {key}, on_worker).get(),
+                  home(key));
+    }
+    for (size_t key = 0; key < 8; ++key) {
+        pool.wait_idle();
+        EXPECT_EQ(pool.submit_after(std::chrono::milliseconds(1),
+                                    ShardMetadata {key},
+                                    on_worker)
+                      .get(),
+                  home(key));
+    }
+    pool.shutdown();
+}
+
+struct TieredConfig : DefaultPoolConfig {
+    static constexpr std::size_t               kHotWorkers = 1;
+    static constexpr std::chrono::microseconds kHotIdleTimeout {500};
+};
+
+TEST(ThreadPoolTest, TieredWorkersPromoteParkedWorkersOnBacklog) {
+    using Pool = BasicThreadPool<4, EmptyMetadata, TieredConfig>;
+    auto queue = std::make_shared<Pool::TaskQueue>(64);
+    Pool pool(queue);
+
+    // Let every worker go cold, then submit a burst that needs all four at
+    // once: the backlog has to wake the parked ones.
+    std::this_thread::sleep_for(5ms);
+    std::promise<void>             release;
+    auto                           gate = release.get_future().share();
+    std::atomic<int>               started {0};
+    std::vector<std::future<void>> blockers;
+    for (int i = 0; i < 4; ++i) {
+        blockers.push_back(pool.submit([&started, gate] {
+            started.fetch_add(1);
+            gate.wait();
+        }));
+    }
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (started.load() < 4 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(started.load(), 4);
+    release.set_value();
+
+    // Then a trickle, served by whichever worker is hot.
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(pool.submit([i] { return i; }).get(), i);
+    }
+    pool.shutdown();
+    for (auto &blocker : blockers) {
+        blocker.get();
+    }
+}
+
+struct LongSpinConfig : DefaultPoolConfig {
+    static constexpr std::size_t               kHotWorkers = 1;
+    static constexpr std::chrono::milliseconds kHotIdleTimeout {10000};
+};
+
+TEST(ThreadPoolTest, TieredWorkersIgnoreDelayedTasksWhenPromoting) {
+    using Pool = BasicThreadPool<4, EmptyMetadata, LongSpinConfig>;
+    auto queue = std::make_shared<Pool::TaskQueue>(64);
+    Pool pool(queue);
+
+    // Pending timer tasks are outstanding but not queued; they must not
+    // make every submit wake a parked worker while the hot one spins.
+    std::vector<std::future<void>> delayed;
+    for (int i = 0; i < 8; ++i) {
+        delayed.push_back(pool.submit_after(10s, [] {}));
+    }
+    std::this_thread::sleep_for(5ms);
+
+    std::set<std::thread::id> runners;
+    for (int i = 0; i < 50; ++i) {
+        runners.insert(
+            pool.submit([] { return std::this_thread::get_id(); }).get());
+        std::this_thread::sleep_for(1ms);  // Back to spinning
+    }
+    EXPECT_LE(runners.size(), 2u);
+    pool.shutdown();
+}
+
+// Latency-oriented: spinning workers, allocation-free task storage, no
+// instrumentation.
+struct LeanConfig : DefaultPoolConfig {
+    using WaitStrategy = SpinBackOffWaitStrategy<>;
+    using Affinity     = PinnedAffinity;
+    static constexpr std::size_t kTaskStorageSize = 16;
+};
+
+struct InstrumentedConfig : DefaultPoolConfig {
+    static constexpr bool kMetrics = true;
+    static constexpr bool kTracing = true;
+};
+
+static_assert(sizeof(BasicThreadPool<2, TestMetadata, LeanConfig>) <
+              sizeof(BasicThreadPool<2, TestMetadata, InstrumentedConfig>));
+
+TEST(ThreadPoolTest, LeanConfigRunsTasksFromInplaceStorage) {
+    using Pool = BasicThreadPool<2, TestMetadata, LeanConfig>;
+    static_assert(
+        std::is_same_v<decltype(Pool::Task::data), InplaceTask<16>>);
+    auto queue = std::make_shared<Pool::TaskQueue>(64);
+    Pool pool(queue);
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 32; ++i) {
+        results.push_back(
+            pool.submit(TestMetadata {.priority = i}, [i] { return i * 2; }));
+    }
+    for (int i = 0; i < 32; ++i) {
+        EXPECT_EQ(results[i].get(), i * 2);
+    }
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, InstrumentedConfigCountsAndTraces) {
+    using Pool = BasicThreadPool<2, TestMetadata, InstrumentedConfig>;
+    auto queue = std::make_shared<Pool::TaskQueue>(4);
+    Pool pool(queue);
+
+    std::mutex                    events_mutex;
+    std::vector<Pool::TraceEvent> events;
+    std::vector<int>              priorities;
+    pool.set_trace_callback([&](const Pool::TraceRecord &record) {
+        std::lock_guard<std::mutex> lock(events_mutex);
+        events.push_back(record.event);
+        priorities.push_back(record.metadata.priority);
+        if (record.event == Pool::TraceEvent::Started ||
+            record.event == Pool::TraceEvent::Finished) {
+            EXPECT_LT(record.worker, 2u);
+        }
+    });
+
+    pool.submit(TestMetadata {.priority = 7}, [] {
+        std::this_thread::sleep_for(1ms);
+    }).get();
+    pool.wait_idle();  // Its Finished event precedes the next Submitted
+    // Delayed tasks are counted and traced the same way.
+    pool.submit_after(1ms, TestMetadata {.priority = 8}, [] {}).get();
+    pool.shutdown();
+    EXPECT_THROW(pool.submit_after(1ms, TestMetadata {.priority = 9}, [] {}),
+                 std::runtime_error);
+
+    {
+        std::lock_guard<std::mutex> lock(events_mutex);
+        EXPECT_EQ(events,
+                  (std::vector<Pool::TraceEvent> {Pool::TraceEvent::Submitted,
+                                                  Pool::TraceEvent::Started,
+                                                  Pool::TraceEvent::Finished,
+                                                  Pool::TraceEvent::Submitted,
+                                                  Pool::TraceEvent::Started,
+                                                  Pool::TraceEvent::Finished,
+                                                  Pool::TraceEvent::Submitted,
+                                                  Pool::TraceEvent::Rejected}));
+        EXPECT_EQ(priorities, (std::vector<int> {7, 7, 7, 8, 8, 8, 9, 9}));
+    }
+    auto metrics = pool.metrics();
+    EXPECT_EQ(metrics.submitted, 2u);
+    EXPECT_EQ(metrics.rejected, 1u);
+    EXPECT_EQ(metrics.completed, 2u);
+    EXPECT_GE(metrics.busy_time, 1ms);
+}
+
+TEST(ThreadPoolTest, InstrumentedConfigCountsRangeHelpers) {
+    using Pool = BasicThreadPool<2, TestMetadata, InstrumentedConfig>;
+    auto queue = std::make_shared<Pool::TaskQueue>(64);
+    Pool pool(queue);
+
+    std::mutex                         events_mutex;
+    std::map<Pool::TraceEvent, size_t> events;
+    pool.set_trace_callback([&](const Pool::TraceRecord &record) {
+        std::lock_guard<std::mutex> lock(events_mutex);
+        ++events[record.event];
+    });
+
+    std::atomic<size_t> sum {0};
+    pool.submit_range(TestMetadata {.priority = 0},
+                      1000,
+                      [&](size_t i) {
+                          sum.fetch_add(i, std::memory_order_relaxed);
+                      },
+                      1)
+        .get();
+    pool.wait_idle();
+    pool.shutdown();
+    EXPECT_EQ(sum.load(), 999u * 1000u / 2);
+
+    // Every claimer, including the helpers it queued, is one task.
+    auto metrics = pool.metrics();
+    EXPECT_GE(metrics.submitted, 1u);
+    EXPECT_EQ(metrics.completed, metrics.submitted);
+
+    std::lock_guard<std::mutex> lock(events_mutex);
+    EXPECT_EQ(events[Pool::TraceEvent::Submitted],
+              metrics.submitted + metrics.rejected);
+    EXPECT_EQ(events[Pool::TraceEvent::Started], metrics.completed);
+    EXPECT_EQ(events[Pool::TraceEvent::Finished], metrics.completed);
+}
+
+#if defined(LC_PLATFORM_LINUX)
+
+TEST(ThreadPoolTest, EventFdWaitStrategyIsPollable) {
+    EventFdWaitStrategy strategy;
+    pollfd              pfd {strategy.native_handle(), POLLIN, 0};
+
+    EXPECT_EQ(::poll(&pfd, 1, 0), 0);
+    EXPECT_FALSE(strategy.try_wait());
+
+    strategy.notify();
+    EXPECT_EQ(::poll(&pfd, 1, 0), 1);
+    EXPECT_TRUE(strategy.try_wait());
+    EXPECT_FALSE(strategy.try_wait());
+
+    // A burst with nobody idle leaves one signal, not one per notify.
+    for (int i = 0; i < 8; ++i) {
+        strategy.notify();
+    }
+    EXPECT_TRUE(strategy.try_wait());
+    EXPECT_FALSE(strategy.try_wait());
+}
+
+TEST(ThreadPoolTest, EventFdWaitStrategyWakesOneWaiter) {
+    EventFdWaitStrategy      strategy;
+    std::atomic<int>         woken {0};
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 3; ++i) {
+        waiters.emplace_back([&] {
+            strategy.wait();
+            woken.fetch_add(1);
+        });
+    }
+    // Let the waiters park; a sticky token granted early would still wake
+    // only one of them.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    strategy.notify();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(woken.load(), 1);
+
+    strategy.notify_all();
+    for (auto &waiter : waiters) {
+        waiter.join();
+    }
+    EXPECT_EQ(woken.load(), 3);
+}
+
+TEST(ThreadPoolTest, EventFdHybridThreadRunsPoolWork) {
+    using Task    = Context<TestMetadata, std::function<void()>>;
+    auto strategy = std::make_shared<EventFdWaitStrategy>();
+    auto queue    = std::make_shared<MPMCQueue<Task>>(128);
+    ThreadPool<2, TestMetadata, EventFdWaitStrategy> pool(queue, strategy);
+
+    auto fut = pool.submit(TestMetadata {.priority = 0}, [] { return 5; });
+    EXPECT_EQ(fut.get(), 5);
+
+    // A hybrid thread multiplexing the pool's eventfd with its own poll set
+    // may also drain queued work.
+    std::atomic<int> ran {0};
+    for (int i = 0; i < 16; ++i) {
+        pool.submit(TestMetadata {.priority = 0}, [&ran] { ++ran; });
+    }
+    pollfd pfd {strategy->native_handle(), POLLIN, 0};
+    while (ran.load() < 16) {
+        if (::poll(&pfd, 1, 10) == 1 && strategy->try_wait()) {
+            pool.run_one();
+        }
+    }
+    EXPECT_EQ(ran.load(), 16);
+
+    pool.shutdown();
+}
+
+#endif  // defined(LC_PLATFORM_LINUX)
@@ -1,9 +1,39 @@
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <array>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "lc_blocking_mpmc_queue.h"
+#include "lc_channel.h"
+#include "lc_config.h"
+#include "lc_core_executor.h"
+#include "lc_coroutine.h"
+#include "lc_dwcas_queue.h"
 #include "lc_mpmc_queue.h"
+#include "lc_multi_queue.h"
+#include "lc_rate_limiter.h"
+#include "lc_scq_queue.h"
+#include "lc_sharded_queue.h"
+#include "lc_singleflight.h"
 #include "lc_thread_pool.h"
 
+#if defined(LC_PLATFORM_LINUX)
+#  include <arpa/inet.h>
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+
+#  include "lc_reactor.h"
+#endif
+
 using namespace lc;
 
 static void BM_ThreadPoolSingleTask(benchmark::State &state) {
@@ -21,6 +51,94 @@ static void BM_ThreadPoolSingleTask(benchmark::State &state) {
 
 BENCHMARK(BM_ThreadPoolSingleTask);
 
+// Same round trip with the watchdog stamping every task.
+static void BM_ThreadPoolSingleTaskWatchdog(benchmark::State &state) {
+    auto queue = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(1024);
+    ThreadPool<4> pool(queue);
+    pool.enable_watchdog(std::chrono::seconds(1), [](const auto &) {});
+
+    for (auto _ : state) {
+        std::promise<void> promise;
+        auto               future = promise.get_future();
+        pool.submit([&promise]() { promise.set_value(); });
+        future.wait();
+    }
+}
+
+BENCHMARK(BM_ThreadPoolSingleTaskWatchdog);
+
+// The same round trip built from pool configs: no instrumentation and
+// allocation-free task storage, versus metrics plus a no-op trace hook.
+struct LeanPoolConfig : DefaultPoolConfig {
+    static constexpr std::size_t kTaskStorageSize = 16;
+};
+
+struct InstrumentedPoolConfig : DefaultPoolConfig {
+    static constexpr bool kMetrics = true;
+    static constexpr bool kTracing = true;
+};
+
+template <typename Config>
+static void configured_single_task(benchmark::State &state) {
+    using Pool = BasicThreadPool<4, EmptyMetadata, Config>;
+    Pool pool(std::make_shared<typename Pool::TaskQueue>(1024));
+    if constexpr (Config::kTracing) {
+        pool.set_trace_callback([](const auto &) {});
+    }
+
+    for (auto _ : state) {
+        std::promise<void> promise;
+        auto               future = promise.get_future();
+        pool.submit([&promise]() { promise.set_value(); });
+        future.wait();
+    }
+}
+
+static void BM_ThreadPoolSingleTaskLean(benchmark::State &state) {
+    configured_single_task<LeanPoolConfig>(state);
+}
+
+BENCHMARK(BM_ThreadPoolSingleTaskLean);
+
+static void BM_ThreadPoolSingleTaskInstrumented(benchmark::State &state) {
+    configured_single_task<InstrumentedPoolConfig>(state);
+}
+
+BENCHMARK(BM_ThreadPoolSingleTaskInstrumented);
+
+// Round-trip latency against total CPU burned (process CPU time): every
+// worker parked, every worker spinning, and one hot worker with the rest
+// parked.
+struct SpinningPoolConfig : DefaultPoolConfig {
+    using WaitStrategy = SpinBackOffWaitStrategy<>;
+};
+
+struct TieredPoolConfig : DefaultPoolConfig {
+    static constexpr std::size_t kHotWorkers = 1;
+};
+
+static void BM_ThreadPoolSingleTaskParked(benchmark::State &state) {
+    configured_single_task<DefaultPoolConfig>(state);
+}
+
+BENCHMARK(BM_ThreadPoolSingleTaskParked)->MeasureProcessCPUTime()
+    ->UseRealTime();
+
+static void BM_ThreadPoolSingleTaskSpinning(benchmark::State &state) {
+    configured_single_task<SpinningPoolConfig>(state);
+}
+
+BENCHMARK(BM_ThreadPoolSingleTaskSpinning)->MeasureProcessCPUTime()
+    ->UseRealTime();
+
+static void BM_ThreadPoolSingleTaskTiered(benchmark::State &state) {
+    configured_single_task<TieredPoolConfig>(state);
+}
+
+BENCHMARK(BM_ThreadPoolSingleTaskTiered)->MeasureProcessCPUTime()
+    ->UseRealTime();
+
 static void cpu_work() {
     volatile int sum = 0;
     for (int i = 0; i < 10000; ++i) {
@@ -70,3 +188,749 @@ static void BM_ThreadPoolConcurrency(benchmark::State &state) {
 }
 
 BENCHMARK(BM_ThreadPoolConcurrency)->Arg(50)->Arg(64)->Arg(512)->Arg(2000);
+
+// Fan out 100k trivial items: one task per item, versus one range entry
+// whose chunks the workers claim.
+static constexpr size_t kFanOutItems = 100000;
+
+static void BM_ThreadPoolFanOutSubmitEach(benchmark::State &state) {
+    auto queue = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(131072);
+    ThreadPool<4>       pool(queue);
+    std::vector<double> data(kFanOutItems, 1.0);
+
+    for (auto _ : state) {
+        std::vector<std::future<void>> results;
+        results.reserve(kFanOutItems);
+        for (size_t i = 0; i < kFanOutItems; ++i) {
+            results.push_back(pool.submit([&data, i] { data[i] *= 1.5; }));
+        }
+        for (auto &f : results) {
+            f.wait();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kFanOutItems);
+}
+
+BENCHMARK(BM_ThreadPoolFanOutSubmitEach)->UseRealTime();
+
+static void BM_ThreadPoolFanOutSubmitRange(benchmark::State &state) {
+    auto queue = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(16);
+    ThreadPool<4>       pool(queue);
+    std::vector<double> data(kFanOutItems, 1.0);
+
+    for (auto _ : state) {
+        pool.submit_range(kFanOutItems, [&data](size_t i) {
+                data[i] *= 1.5;
+            }).wait();
+    }
+    state.SetItemsProcessed(state.iterations() * kFanOutItems);
+}
+
+BENCHMARK(BM_ThreadPoolFanOutSubmitRange)->UseRealTime();
+
+// A batch phase of 64 short tasks, synchronized with wait_idle() instead
+// of collecting futures.
+static void BM_ThreadPoolBatchWaitIdle(benchmark::State &state) {
+    auto queue = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(1024);
+    ThreadPool<4>    pool(queue);
+    std::atomic<int> counter {0};
+
+    for (auto _ : state) {
+        for (int i = 0; i < 64; ++i) {
+            pool.submit([&counter] { counter.fetch_add(1); });
+        }
+        pool.wait_idle();
+    }
+}
+
+BENCHMARK(BM_ThreadPoolBatchWaitIdle)->UseRealTime();
+
+// A cache-miss storm: 64 requests for the same cold key, each needing a
+// load that spins for a while. Plain submit runs the load 64 times;
+// submit_dedup runs it once and hands everyone the shared result.
+static int SlowLoad() {
+    int value = 0;
+    for (int i = 0; i < 20000; ++i) {
+        benchmark::DoNotOptimize(value += i);
+    }
+    return value;
+}
+
+static void BM_ThreadPoolMissStormSubmit(benchmark::State &state) {
+    auto queue = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(1024);
+    ThreadPool<4> pool(queue);
+
+    std::vector<std::future<int>> results;
+    for (auto _ : state) {
+        for (int i = 0; i < 64; ++i) {
+            results.push_back(pool.submit(SlowLoad));
+        }
+        for (auto &result : results) {
+            benchmark::DoNotOptimize(result.get());
+        }
+        results.clear();
+    }
+}
+
+BENCHMARK(BM_ThreadPoolMissStormSubmit)->UseRealTime();
+
+static void BM_ThreadPoolMissStormDedup(benchmark::State &state) {
+    auto queue = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(1024);
+    ThreadPool<4>          pool(queue);
+    SingleFlight<int, int> flights;
+
+    std::vector<std::shared_future<int>> results;
+    for (auto _ : state) {
+        for (int i = 0; i < 64; ++i) {
+            results.push_back(pool.submit_dedup(flights, 1, SlowLoad));
+        }
+        for (auto &result : results) {
+            benchmark::DoNotOptimize(result.get());
+        }
+        results.clear();
+    }
+}
+
+BENCHMARK(BM_ThreadPoolMissStormDedup)->UseRealTime();
+
+// Tasks that build a 1 KiB scratch vector: from the heap, or from the
+// worker's arena, which is rewound after each task instead of freed.
+static void BM_ThreadPoolScratchHeap(benchmark::State &state) {
+    auto queue = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(1024);
+    ThreadPool<4> pool(queue);
+
+    for (auto _ : state) {
+        for (int i = 0; i < 64; ++i) {
+            pool.submit([] {
+                std::vector<int> scratch(256, 1);
+                benchmark::DoNotOptimize(scratch.data());
+            });
+        }
+        pool.wait_idle();
+    }
+}
+
+BENCHMARK(BM_ThreadPoolScratchHeap)->UseRealTime();
+
+static void BM_ThreadPoolScratchArena(benchmark::State &state) {
+    auto queue = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(1024);
+    ThreadPool<4> pool(queue);
+
+    for (auto _ : state) {
+        for (int i = 0; i < 64; ++i) {
+            pool.submit([&pool] {
+                std::pmr::vector<int> scratch(256, 1, &pool.arena());
+                benchmark::DoNotOptimize(scratch.data());
+            });
+        }
+        pool.wait_idle();
+    }
+}
+
+BENCHMARK(BM_ThreadPoolScratchArena)->UseRealTime();
+
+// Shard-local work: four 256 KiB shards, each read-modify-written by
+// every task for that shard. Without affinity the tasks land on any
+// worker and drag the shard's lines between cores; with affinity_key
+// routing each shard stays in one worker's cache. Run with
+// --benchmark_perf_counters=CACHE-MISSES to see the difference directly.
+struct ShardAffinityConfig : DefaultPoolConfig {
+    static constexpr std::size_t kWorkerQueueSize = 256;
+};
+
+struct UnkeyedShardTask {
+    size_t shard = 0;
+};
+
+struct KeyedShardTask {
+    size_t affinity_key = 0;
+};
+
+template <typename Meta>
+static void shard_local_tasks(benchmark::State &state) {
+    constexpr size_t kShards     = 4;
+    constexpr size_t kShardWords = 256 * 1024 / sizeof(uint64_t);
+
+    using Pool = BasicThreadPool<4, Meta, ShardAffinityConfig>;
+    Pool pool(std::make_shared<typename Pool::TaskQueue>(1024));
+    std::vector<std::vector<uint64_t>> shards(
+        kShards,
+        std::vector<uint64_t>(kShardWords, 1));
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < 64; ++i) {
+            size_t shard = i % kShards;
+            pool.submit(Meta {shard}, [&words = shards[shard]] {
+                for (auto &word : words) {
+                    word = word * 3 + 1;
+                }
+            });
+        }
+        pool.wait_idle();
+    }
+}
+
+static void BM_ThreadPoolShardScanUnkeyed(benchmark::State &state) {
+    shard_local_tasks<UnkeyedShardTask>(state);
+}
+
+BENCHMARK(BM_ThreadPoolShardScanUnkeyed)->UseRealTime();
+
+static void BM_ThreadPoolShardScanAffinity(benchmark::State &state) {
+    shard_local_tasks<KeyedShardTask>(state);
+}
+
+BENCHMARK(BM_ThreadPoolShardScanAffinity)->UseRealTime();
+
+// Message-passing throughput: a driver on one core sends 256 small
+// messages spread over the other cores and awaits them all. The
+// thread-per-core executor carries them over per-pair SPSC rings; the
+// pool baseline pushes the same messages through its shared MPMC queue.
+using MeshExecutor = CoreExecutor<4, NoAffinity>;
+
+static DetachedTask send_round(MeshExecutor &cores, std::promise<void> &done) {
+    std::vector<CoreFuture<int>> replies;
+    replies.reserve(256);
+    for (int i = 0; i < 256; ++i) {
+        replies.push_back(
+            cores.submit_to_core(1 + i % 3, [i] { return i; }));
+    }
+    int sum = 0;
+    for (auto &reply : replies) {
+        sum += co_await reply;
+    }
+    benchmark::DoNotOptimize(sum);
+    done.set_value();
+}
+
+static void BM_CoreExecutorMessages(benchmark::State &state) {
+    MeshExecutor cores;
+    for (auto _ : state) {
+        std::promise<void> done;
+        cores.submit_to_core(0, [&] { send_round(cores, done); });
+        done.get_future().wait();
+    }
+    state.SetItemsProcessed(state.iterations() * 256);
+}
+
+BENCHMARK(BM_CoreExecutorMessages)->UseRealTime();
+
+static void BM_ThreadPoolMessages(benchmark::State &state) {
+    auto queue = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(1024);
+    ThreadPool<4> pool(queue);
+    for (auto _ : state) {
+        std::vector<std::future<int>> replies;
+        replies.reserve(256);
+        for (int i = 0; i < 256; ++i) {
+            replies.push_back(pool.submit([i] { return i; }));
+        }
+        int sum = 0;
+        for (auto &reply : replies) {
+            sum += reply.get();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 256);
+}
+
+BENCHMARK(BM_ThreadPoolMessages)->UseRealTime();
+
+static void BM_MPMCQueueRoundTrip(benchmark::State &state) {
+    MPMCQueue<int> queue(1024);
+    int            value = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(queue.enqueue(value));
+        benchmark::DoNotOptimize(queue.dequeue(value));
+    }
+}
+
+BENCHMARK(BM_MPMCQueueRoundTrip);
+
+static void BM_BlockingMPMCQueueRoundTrip(benchmark::State &state) {
+    BlockingMPMCQueue<int> queue(1024);
+    int                    value = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(queue.push(value));
+        benchmark::DoNotOptimize(queue.pop(value));
+    }
+}
+
+BENCHMARK(BM_BlockingMPMCQueueRoundTrip);
+
+// A 256-byte payload, so every extra move shows up as a copy.
+struct LargePayload {
+    explicit LargePayload(int seed) {
+        words.fill(seed);
+    }
+
+    std::array<int, 64> words;
+};
+
+static void BM_MPMCQueueEnqueueLarge(benchmark::State &state) {
+    MPMCQueue<LargePayload> queue(1024);
+    for (auto _ : state) {
+        LargePayload payload(1);
+        benchmark::DoNotOptimize(queue.enqueue(std::move(payload)));
+        auto out = queue.try_dequeue();
+        benchmark::DoNotOptimize(out);
+    }
+}
+
+BENCHMARK(BM_MPMCQueueEnqueueLarge);
+
+static void BM_MPMCQueueEmplaceLarge(benchmark::State &state) {
+    MPMCQueue<LargePayload> queue(1024);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(queue.emplace(1));
+        queue.consume([](LargePayload &&item) {
+            benchmark::DoNotOptimize(item.words[0]);
+        });
+    }
+}
+
+BENCHMARK(BM_MPMCQueueEmplaceLarge);
+
+// N:N contention on pointer-sized payloads: every benchmark thread both
+// produces and consumes on one shared queue.
+template <typename Queue>
+static void queue_contention(benchmark::State &state, Queue &queue) {
+    uintptr_t value = 1;
+    for (auto _ : state) {
+        while (!queue.enqueue(value)) {}
+        while (!queue.dequeue(value)) {}
+    }
+}
+
+static void BM_MPMCQueueContention(benchmark::State &state) {
+    static MPMCQueue<uintptr_t> queue(1024);
+    queue_contention(state, queue);
+}
+
+BENCHMARK(BM_MPMCQueueContention)->ThreadRange(1, 64)->UseRealTime();
+
+static void BM_DWCASQueueContention(benchmark::State &state) {
+    static DWCASQueue<uintptr_t> queue(1024);
+    queue_contention(state, queue);
+}
+
+BENCHMARK(BM_DWCASQueueContention)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_SCQueueContention(benchmark::State &state) {
+    static SCQueue<uintptr_t> queue(1024);
+    queue_contention(state, queue);
+}
+
+BENCHMARK(BM_SCQueueContention)->ThreadRange(1, 64)->UseRealTime();
+
+static void BM_ShardedQueueContention(benchmark::State &state) {
+    static ShardedQueue<uintptr_t> queue(1024, 8);
+    queue_contention(state, queue);
+}
+
+BENCHMARK(BM_ShardedQueueContention)->ThreadRange(1, 64)->UseRealTime();
+
+// Producer threads submitting empty tasks to one pool; reports the
+// aggregate submit rate.
+template <template <typename> class Queue>
+static void pool_producers(benchmark::State &state) {
+    using Task = Context<EmptyMetadata, std::function<void()>>;
+    static auto queue = std::make_shared<Queue<Task>>(8192);
+    static ThreadPool<4, EmptyMetadata, AtomicWaitStrategy, Queue> pool(queue);
+    for (auto _ : state) {
+        while (!pool.try_submit([] {})) {
+            std::this_thread::yield();  // Queue full
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_PoolProducersMPMCQueue(benchmark::State &state) {
+    pool_producers<MPMCQueue>(state);
+}
+
+BENCHMARK(BM_PoolProducersMPMCQueue)->ThreadRange(1, 64)->UseRealTime();
+
+static void BM_PoolProducersShardedQueue(benchmark::State &state) {
+    pool_producers<ShardedQueue>(state);
+}
+
+BENCHMARK(BM_PoolProducersShardedQueue)->ThreadRange(1, 64)->UseRealTime();
+
+// Strict baseline for MultiQueue: one std::priority_queue behind a mutex.
+template <typename Tp_>
+class LockedHeap {
+public:
+    explicit LockedHeap(std::size_t capacity) : capacity_(capacity) {}
+
+    bool enqueue(Tp_ value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (heap_.size() == capacity_) {
+            return false;
+        }
+        heap_.push(value);
+        return true;
+    }
+
+    bool dequeue(Tp_ &value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (heap_.empty()) {
+            return false;
+        }
+        value = heap_.top();
+        heap_.pop();
+        return true;
+    }
+
+private:
+    std::mutex               mutex_;
+    std::priority_queue<Tp_> heap_;
+    std::size_t              capacity_;
+};
+
+// Like queue_contention(), with a fresh random priority per push.
+template <typename Queue>
+static void priority_contention(benchmark::State &state, Queue &queue) {
+    std::minstd_rand random(state.thread_index() + 1);
+    uintptr_t        value = 0;
+    for (auto _ : state) {
+        while (!queue.enqueue(random() % 1024)) {}
+        while (!queue.dequeue(value)) {}
+    }
+}
+
+static void BM_LockedHeapContention(benchmark::State &state) {
+    static LockedHeap<uintptr_t> queue(1024);
+    priority_contention(state, queue);
+}
+
+BENCHMARK(BM_LockedHeapContention)->ThreadRange(1, 64)->UseRealTime();
+
+static void BM_MultiQueueContention(benchmark::State &state) {
+    static MultiQueue<uintptr_t> queue(1024);
+    priority_contention(state, queue);
+}
+
+BENCHMARK(BM_MultiQueueContention)->ThreadRange(1, 64)->UseRealTime();
+
+// Rank error of MultiQueue pops: fill with distinct priorities, drain, and
+// count for every pop how many better values were still queued. A strict
+// priority queue scores 0.
+static void BM_MultiQueueRankError(benchmark::State &state) {
+    const std::size_t heaps  = state.range(0);
+    constexpr int     kItems = 4096;
+
+    std::vector<int> keys(kItems);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::minstd_rand(1));
+
+    double total_error = 0;
+    for (auto _ : state) {
+        MultiQueue<int> queue(kItems, heaps);
+        for (int key : keys) {
+            benchmark::DoNotOptimize(queue.enqueue(key));
+        }
+        // Fenwick tree over popped keys.
+        std::vector<int> popped(kItems + 1, 0);
+        for (int i = 0; i < kItems; ++i) {
+            int key     = *queue.try_dequeue();
+            int smaller = 0;  // popped keys <= key
+            for (int j = key + 1; j > 0; j -= j & -j) {
+                smaller += popped[j];
+            }
+            // Keys above `key` that are still queued.
+            total_error += (kItems - 1 - key) - (i - smaller);
+            for (int j = key + 1; j <= kItems; j += j & -j) {
+                ++popped[j];
+            }
+        }
+    }
+    state.counters["rank_error"] =
+        total_error / (static_cast<double>(state.iterations()) * kItems);
+}
+
+BENCHMARK(BM_MultiQueueRankError)->RangeMultiplier(2)->Range(1, 64);
+
+static void BM_ChannelRoundTrip(benchmark::State &state) {
+    Channel<int> channel(1024);
+    for (auto _ : state) {
+        channel.send(1);
+        benchmark::DoNotOptimize(channel.recv());
+    }
+}
+
+BENCHMARK(BM_ChannelRoundTrip);
+
+// Ping-pong between two threads, so every recv has to park.
+static void BM_ChannelPingPong(benchmark::State &state) {
+    Channel<int> ping(2);
+    Channel<int> pong(2);
+    std::thread  echo([&] {
+        for (int value : ping) {
+            pong.send(value);
+        }
+    });
+    for (auto _ : state) {
+        ping.send(1);
+        benchmark::DoNotOptimize(pong.recv());
+    }
+    ping.close();
+    echo.join();
+}
+
+BENCHMARK(BM_ChannelPingPong)->UseRealTime();
+
+static void BM_TokenBucketAcquire(benchmark::State &state) {
+    static TokenBucket bucket(1e12, 1024);
+    int64_t            now =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(bucket.acquire(now));
+    }
+}
+
+BENCHMARK(BM_TokenBucketAcquire)->ThreadRange(1, 8);
+
+struct RateMetadata {
+    size_t task_class;
+};
+
+// Submits a burst at a capped rate and reports the rate actually achieved.
+static void BM_RateLimitedSubmit(benchmark::State &state) {
+    const double rate  = static_cast<double>(state.range(0));
+    const int    tasks = 200;
+    auto         queue = std::make_shared<
+        MPMCQueue<Context<RateMetadata, std::function<void()>>>>(1024);
+    ThreadPool<4, RateMetadata> pool(queue);
+    pool.set_rate_limit(1, rate);
+
+    double achieved = 0.0;
+    for (auto _ : state) {
+        std::vector<std::future<void>> results;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < tasks; ++i) {
+            results.push_back(
+                pool.submit(RateMetadata {.task_class = 1}, [] {}));
+        }
+        for (auto &f : results) {
+            f.wait();
+        }
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        achieved = (tasks - 1) / elapsed.count();
+    }
+    state.counters["target_rate"]   = rate;
+    state.counters["achieved_rate"] = achieved;
+}
+
+BENCHMARK(BM_RateLimitedSubmit)
+    ->Arg(2000)
+    ->Arg(20000)
+    ->Iterations(3)
+    ->UseRealTime();
+
+static void spin_until(std::chrono::steady_clock::time_point deadline) {
+    while (std::chrono::steady_clock::now() < deadline) {}
+}
+
+// Offer 20us tasks to four workers at twice the rate they can drain them
+// and report the queueing latency of the tasks that were run.
+static void run_overload(benchmark::State &state, ThreadPool<4> &pool) {
+    constexpr int        kOffers   = 40000;
+    constexpr auto       kInterval = std::chrono::nanoseconds(2500);
+    std::vector<int64_t> waited(kOffers);
+    double               p99      = 0.0;
+    double               served   = 0.0;
+    for (auto _ : state) {
+        std::fill(waited.begin(), waited.end(), -1);
+        std::vector<std::future<void>> results;
+        results.reserve(kOffers);
+        auto next = std::chrono::steady_clock::now();
+        for (int i = 0; i < kOffers; ++i) {
+            auto offered = std::chrono::steady_clock::now();
+            auto result  = pool.try_submit([&waited, i, offered] {
+                auto start = std::chrono::steady_clock::now();
+                waited[i]  = (start - offered).count();
+                spin_until(start + std::chrono::microseconds(20));
+            });
+            if (result) {
+                results.push_back(std::move(*result));
+            }
+            next += kInterval;
+            spin_until(next);
+        }
+        for (auto &f : results) {
+            f.wait();
+        }
+        std::vector<int64_t> latencies;
+        for (int64_t ns : waited) {
+            if (ns >= 0) {
+                latencies.push_back(ns);
+            }
+        }
+        std::sort(latencies.begin(), latencies.end());
+        p99      = latencies[latencies.size() * 99 / 100] / 1e3;
+        served   = static_cast<double>(latencies.size()) / kOffers;
+    }
+    state.counters["p99_queue_us"] = p99;
+    state.counters["served"]       = served;
+}
+
+static void BM_OverloadFixedQueue(benchmark::State &state) {
+    auto queue = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(4096);
+    ThreadPool<4> pool(queue);
+    run_overload(state, pool);
+}
+
+BENCHMARK(BM_OverloadFixedQueue)->Iterations(3)->UseRealTime();
+
+static void BM_OverloadAdaptiveAdmission(benchmark::State &state) {
+    auto queue = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(4096);
+    ThreadPool<4> pool(queue);
+    pool.set_admission_control(
+        {.target_latency = std::chrono::milliseconds(1)});
+    run_overload(state, pool);
+    state.counters["limit"] = static_cast<double>(pool.admission_limit());
+}
+
+BENCHMARK(BM_OverloadAdaptiveAdmission)->Iterations(3)->UseRealTime();
+
+static void BM_OverloadCodel(benchmark::State &state) {
+    auto queue = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(4096);
+    ThreadPool<4> pool(queue);
+    pool.set_codel({.target_delay = std::chrono::milliseconds(1),
+                    .interval     = std::chrono::milliseconds(10)});
+    run_overload(state, pool);
+    state.counters["dropped"] = static_cast<double>(pool.dropped_tasks());
+}
+
+BENCHMARK(BM_OverloadCodel)->Iterations(3)->UseRealTime();
+
+#if defined(LC_PLATFORM_LINUX)
+
+static constexpr size_t kEchoMessageSize = 64;
+
+// Connect a client to a freshly accepted server socket over 127.0.0.1.
+static std::pair<int, int> make_loopback_pair() {
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+
+    sockaddr_in addr {};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port        = 0;
+    ::bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    ::listen(listener, 1);
+    socklen_t len = sizeof(addr);
+    ::getsockname(listener, reinterpret_cast<sockaddr *>(&addr), &len);
+
+    int client = ::socket(AF_INET, SOCK_STREAM, 0);
+    ::connect(client, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    int server = ::accept(listener, nullptr, nullptr);
+    ::close(listener);
+
+    int one = 1;
+    ::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    ::setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return {client, server};
+}
+
+static void echo_once(int fd) {
+    char    buf[kEchoMessageSize];
+    ssize_t n = ::read(fd, buf, sizeof(buf));
+    if (n > 0) {
+        LC_MAYBE_UNUSED ssize_t w = ::write(fd, buf, static_cast<size_t>(n));
+    }
+}
+
+static void client_round_trip(benchmark::State &state, int client) {
+    char message[kEchoMessageSize] = {};
+    for (auto _ : state) {
+        LC_MAYBE_UNUSED ssize_t w = ::write(client, message, sizeof(message));
+        size_t                  received = 0;
+        while (received < sizeof(message)) {
+            ssize_t n = ::read(client, message, sizeof(message) - received);
+            if (n <= 0) {
+                state.SkipWithError("echo connection closed");
+                return;
+            }
+            received += static_cast<size_t>(n);
+        }
+    }
+}
+
+// Pool workers take turns as the reactor leader and echo in place.
+static void BM_ReactorLoopbackEcho(benchmark::State &state) {
+    auto [client, server] = make_loopback_pair();
+    auto strategy         = std::make_shared<ReactorWaitStrategy>();
+    auto queue            = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(1024);
+    ThreadPool<4, EmptyMetadata, ReactorWaitStrategy> pool(queue, strategy);
+    strategy->reactor().add(server, EPOLLIN, [server = server](uint32_t) {
+        echo_once(server);
+    });
+
+    client_round_trip(state, client);
+
+    strategy->reactor().remove(server);
+    pool.shutdown();
+    ::close(client);
+    ::close(server);
+}
+
+BENCHMARK(BM_ReactorLoopbackEcho)->UseRealTime();
+
+// Baseline: a dedicated event loop thread forwards readiness to submit().
+static void BM_EventLoopThreadLoopbackEcho(benchmark::State &state) {
+    auto [client, server] = make_loopback_pair();
+    auto queue            = std::make_shared<
+        MPMCQueue<Context<EmptyMetadata, std::function<void()>>>>(1024);
+    ThreadPool<4> pool(queue);
+
+    int               epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    std::atomic<bool> running {true};
+    epoll_event       ev {};
+    ev.events  = EPOLLIN | EPOLLONESHOT;
+    ev.data.fd = server;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server, &ev);
+
+    std::thread loop([&, server = server] {
+        epoll_event ready;
+        while (running.load(std::memory_order_relaxed)) {
+            if (::epoll_wait(epoll_fd, &ready, 1, 10) != 1) {
+                continue;
+            }
+            pool.submit([&, server] {
+                echo_once(server);
+                epoll_event rearm {};
+                rearm.events  = EPOLLIN | EPOLLONESHOT;
+                rearm.data.fd = server;
+                ::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, server, &rearm);
+            });
+        }
+    });
+
+    client_round_trip(state, client);
+
+    running.store(false, std::memory_order_relaxed);
+    loop.join();
+    pool.shutdown();
+    ::close(epoll_fd);
+    ::close(client);
+    ::close(server);
+}
+
+BENCHMARK(BM_EventLoopThreadLoopbackEcho)->UseRealTime();
+
+#endif  // defined(LC_PLATFORM_LINUX)
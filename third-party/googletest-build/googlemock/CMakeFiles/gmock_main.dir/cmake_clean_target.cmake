@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "/tmp/rv/lib/libgmock_main.a"
+)